@@ -0,0 +1,52 @@
+#include "alloc_counter.hpp"
+
+#include "heap_stats.hpp"
+
+#include <cstdlib>
+#include <new>
+
+namespace bench {
+
+    AllocStats allocStats() {
+        HeapStats stats;
+        getHeapStats(stats);
+        return { stats.allocations - stats.frees, stats.currentBytes, stats.allocations, stats.peakBytes };
+    }
+
+    void resetPeak() {
+        resetHeapPeak();
+    }
+
+}
+
+/*
+ * libstdc++'s operator new lives in the shared library where -Wl,--wrap can't
+ * reach its malloc calls, so route it through a malloc call of our own. On the
+ * console libstdc++ is linked statically and this isn't needed.
+ */
+void *operator new(size_t size) {
+    void *ptr = std::malloc(size == 0 ? 1 : size);
+    if (ptr == nullptr)
+        std::abort();
+    return ptr;
+}
+
+void operator delete(void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete[](void *ptr) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept {
+    operator delete(ptr);
+}
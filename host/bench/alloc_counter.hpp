@@ -0,0 +1,26 @@
+#pragma once
+
+#include <switch.h>
+
+/* Heap traffic of the bench process, as counted by heap_stats. */
+namespace bench {
+
+    struct AllocStats {
+        /* Live allocations and bytes. */
+        u64 allocations;
+        u64 bytes;
+        /* Allocations made so far and the most bytes live at once since the last resetPeak(). */
+        u64 total;
+        u64 peakBytes;
+    };
+
+    AllocStats allocStats();
+    void resetPeak();
+
+    /* Allocations and bytes still live since start was taken, how many were made and the peak above start. */
+    inline AllocStats allocDelta(const AllocStats &start) {
+        AllocStats now = allocStats();
+        return { now.allocations - start.allocations, now.bytes - start.bytes, now.total - start.total, now.peakBytes - start.bytes };
+    }
+
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <switch.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <json.hpp>
+
+namespace bench {
+
+    inline volatile u64 sink;
+
+    /* Keeps the compiler from dropping work whose result is otherwise unused. */
+    inline void consume(u64 value) {
+        sink = value;
+    }
+
+    struct Result {
+        std::string name;
+        u32 iterations;
+        u64 items;
+        u64 bytes;
+        u64 nsMin;
+        u64 nsMedian;
+        double nsMean;
+        u64 errors;
+    };
+
+    /*
+     * Times fn over iterations runs, items and bytes describe the work done by a single run.
+     * fn returns how many of its operations failed, which is summed over the timed runs.
+     */
+    template <typename F>
+    Result run(const char *name, u32 iterations, u64 items, u64 bytes, F &&fn) {
+        std::vector<u64> samples;
+        samples.reserve(iterations);
+        u64 errors = 0;
+
+        /* One untimed warmup so lazy allocations don't end up in the first sample. */
+        fn();
+        for (u32 i = 0; i < iterations; i++) {
+            u64 start = armGetSystemTick();
+            errors += fn();
+            samples.push_back(armTicksToNs(armGetSystemTick() - start));
+        }
+
+        std::sort(samples.begin(), samples.end());
+        double sum = 0;
+        for (u64 sample : samples)
+            sum += sample;
+
+        return {
+            .name = name,
+            .iterations = iterations,
+            .items = items,
+            .bytes = bytes,
+            .nsMin = samples.front(),
+            .nsMedian = samples[samples.size() / 2],
+            .nsMean = sum / samples.size(),
+            .errors = errors,
+        };
+    }
+
+    inline nlohmann::json toJson(const Result &result) {
+        nlohmann::json out = {
+            {"name", result.name},
+            {"iterations", result.iterations},
+            {"items", result.items},
+            {"ns_min", result.nsMin},
+            {"ns_median", result.nsMedian},
+            {"ns_mean", result.nsMean},
+            {"errors", result.errors},
+        };
+        if (result.items > 0)
+            out["ns_per_item"] = double(result.nsMedian) / result.items;
+        if (result.bytes > 0 && result.nsMedian > 0)
+            out["mib_per_s"] = (double(result.bytes) / (1024 * 1024)) / (result.nsMedian / 1e9);
+        return out;
+    }
+
+}
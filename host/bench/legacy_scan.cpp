@@ -0,0 +1,77 @@
+#include "legacy_scan.hpp"
+
+#include "dir_iterator.hpp"
+#include "sysmodule.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+
+#include <json.hpp>
+using json = nlohmann::json;
+
+namespace legacy {
+
+    Result readToolboxFile(FsFileSystem *fs, const char *titleDir, std::string &data) {
+        char path[FS_MAX_PATH];
+        std::snprintf(path, FS_MAX_PATH, "/atmosphere/contents/%.*s/toolbox.json", FS_MAX_PATH - 35, titleDir);
+
+        FsFile toolboxFile;
+        Result rc = fsFsOpenFile(fs, path, FsOpenMode_Read, &toolboxFile);
+        if (R_FAILED(rc))
+            return rc;
+
+        s64 size;
+        rc = fsFileGetSize(&toolboxFile, &size);
+        if (R_SUCCEEDED(rc)) {
+            data.assign(size, '\0');
+            u64 bytesRead;
+            rc = fsFileRead(&toolboxFile, 0, data.data(), size, FsReadOption_None, &bytesRead);
+        }
+
+        fsFileClose(&toolboxFile);
+        return rc;
+    }
+
+    bool parseToolbox(const std::string &data, ToolboxInfo &info) {
+        json toolboxFileContent = json::parse(data, nullptr, false);
+        if (toolboxFileContent.is_discarded() || !toolboxFileContent.is_object())
+            return false;
+
+        auto tid = toolboxFileContent.find("tid");
+        auto name = toolboxFileContent.find("name");
+        auto needReboot = toolboxFileContent.find("requires_reboot");
+        if (tid == toolboxFileContent.end() || !tid->is_string())
+            return false;
+        if (name == toolboxFileContent.end() || !name->is_string())
+            return false;
+        if (needReboot == toolboxFileContent.end() || !needReboot->is_boolean())
+            return false;
+
+        info.programId = std::strtoul(tid->get_ref<const std::string &>().c_str(), nullptr, 16);
+        info.name = name->get<std::string>();
+        info.needReboot = needReboot->get<bool>();
+        return true;
+    }
+
+    Result scanModules(FsFileSystem *fs, std::list<ToolboxInfo> &modules) {
+        FsDir contentDir;
+        Result rc = fsFsOpenDirectory(fs, "/atmosphere/contents", FsDirOpenMode_ReadDirs, &contentDir);
+        if (R_FAILED(rc))
+            return rc;
+
+        std::string toolBoxData;
+        for (const auto &entry : FsDirIterator(contentDir)) {
+            if (R_FAILED(readToolboxFile(fs, entry.name, toolBoxData)))
+                continue;
+
+            ToolboxInfo toolbox;
+            if (!parseToolbox(toolBoxData, toolbox) || toolbox.programId == TeslaProgramId)
+                continue;
+
+            modules.push_back(std::move(toolbox));
+        }
+        fsDirClose(&contentDir);
+        return 0;
+    }
+
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <switch.h>
+
+#include <list>
+#include <string>
+
+/*
+ * The scan as it was before module metadata moved into an arena: a std::string
+ * per toolbox.json, a json DOM per parse and a heap node per module. Kept as the
+ * baseline the arena scan is measured against.
+ */
+namespace legacy {
+
+    struct ToolboxInfo {
+        u64 programId;
+        std::string name;
+        bool needReboot;
+    };
+
+    Result readToolboxFile(FsFileSystem *fs, const char *titleDir, std::string &data);
+    bool parseToolbox(const std::string &data, ToolboxInfo &info);
+
+    Result scanModules(FsFileSystem *fs, std::list<ToolboxInfo> &modules);
+
+}
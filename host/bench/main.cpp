@@ -0,0 +1,1135 @@
+#include "alloc_counter.hpp"
+#include "bench.hpp"
+#include "legacy_scan.hpp"
+
+#include "corpus.hpp"
+#include "dir_iterator.hpp"
+#include "event_journal.hpp"
+#include "fake_switch.hpp"
+#include "frame_profiler.hpp"
+#include "headless.hpp"
+#include "heap_stats.hpp"
+#include "ipc_stats.hpp"
+#include "libnx_backend.hpp"
+#include "memory_backend.hpp"
+#include "module_engine.hpp"
+#include "module_scanner.hpp"
+#include "module_search.hpp"
+#include "module_table.hpp"
+#include "module_usage.hpp"
+#include "program_id.hpp"
+#include "row_window.hpp"
+#include "sysmodule.hpp"
+#include "toolbox.hpp"
+#include "work_pool.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <list>
+#include <thread>
+
+namespace {
+
+    /* These read the corpus's malformed toolbox.json files, so their errors count what was rejected. */
+    constexpr std::string_view MalformedCorpusBenches[] = { "toolbox_parse_legacy", "toolbox_parse", "scan_legacy" };
+
+    struct Config {
+        corpus::Config corpus;
+        u32 iterations = 50;
+        u32 listModules = 500;
+        u32 tableModules = 10000;
+        u64 scanLatencyNs = 50000;
+        const char *only = nullptr;
+        fake::Fault latency;
+        std::vector<std::pair<fake::Call, fake::Fault>> faults;
+    };
+
+    void formatFlagPath(char *path, const ContentRoot &root, u64 programId) {
+        std::snprintf(path, FS_MAX_PATH, "%s/%016lX/%s", root.path, programId, root.boot2Flag);
+    }
+
+    /* NAME:PERCENT:RESULT[:PATH], e.g. open_file:100:514:boot-sxos.dat */
+    bool parseFault(const char *arg, Config &config) {
+        std::string_view spec(arg);
+        std::string_view fields[4];
+        size_t count = 0;
+        while (count < 4) {
+            size_t separator = count < 3 ? spec.find(':') : std::string_view::npos;
+            fields[count++] = spec.substr(0, separator);
+            if (separator == std::string_view::npos)
+                break;
+            spec.remove_prefix(separator + 1);
+        }
+        if (count < 3)
+            return false;
+
+        fake::Call call = fake::parseCall(fields[0]);
+        if (call == fake::Call::Count)
+            return false;
+
+        fake::Fault fault;
+        fault.errorPercent = std::strtoul(std::string(fields[1]).c_str(), nullptr, 0);
+        fault.error = std::strtoul(std::string(fields[2]).c_str(), nullptr, 0);
+        fault.pathFilter = fields[3];
+        config.faults.emplace_back(call, fault);
+        return true;
+    }
+
+    /*
+     * Stand-in for tsl::elm::ListItem, which can't be built on the host. It owns the
+     * same kind of memory: the Element base state, a click listener and the text and
+     * value strings together with the copies the item derives from them for drawing.
+     */
+    struct RowStandIn {
+        void *parent;
+        s32 x, y, width, height;
+        bool focused;
+        std::function<bool(u64)> clickListener;
+        std::string text, value, scrollText, ellipsisText;
+        float scrollOffset, scrollAnimationCounter;
+        u32 maxWidth, textWidth;
+
+        virtual ~RowStandIn() = default;
+    };
+
+    std::string moduleName(u32 index) {
+        return "Synthetic sysmodule #" + std::to_string(index);
+    }
+
+    ModuleTable buildTable(ScanArena &arena, u32 modules) {
+        ModuleTable table;
+        ModuleTable::Builder builder(arena);
+        for (u32 i = 0; i < modules; i++)
+            builder.add(0x0100000000001000ULL + i, 0, arena.copy(moduleName(i)), i % 3 == 0 ? ModuleTable::Flag_NeedReboot : 0);
+        builder.build(table);
+        return table;
+    }
+
+    /* One row and list node per module, like createUI did before the list was virtualized. */
+    bench::AllocStats measureEagerRows(u32 modules) {
+        struct ListedModule {
+            RowStandIn *listItem;
+            u64 programId;
+            bool needReboot;
+        };
+
+        bench::AllocStats start = bench::allocStats();
+        std::list<ListedModule> list;
+        for (u32 i = 0; i < modules; i++) {
+            ListedModule module = { new RowStandIn(), 0x0100000000001000ULL + i, i % 3 == 0 };
+            module.listItem->text = moduleName(i);
+            module.listItem->clickListener = [module, list = &list](u64) { return module.programId != 0 && list != nullptr; };
+            list.push_back(module);
+        }
+        bench::AllocStats used = bench::allocDelta(start);
+
+        for (auto &module : list)
+            delete module.listItem;
+        return used;
+    }
+
+    /* Compact module array plus a fixed pool of recycled rows for each of the two lists. */
+    bench::AllocStats measureVirtualRows(u32 modules) {
+        bench::AllocStats start = bench::allocStats();
+        ScanArena arena;
+        ModuleTable table = buildTable(arena, modules);
+
+        std::vector<RowStandIn *> rows;
+        for (auto [begin, count] : { std::pair{ 0u, table.dynamicCount() }, std::pair{ table.staticBegin(), table.staticCount() } }) {
+            RowWindow window(5, 2);
+            window.setCount(count);
+            for (u32 slot = 0; slot < std::min(count, window.poolSize()); slot++) {
+                auto *row = rows.emplace_back(new RowStandIn());
+                row->text = table.name(begin + slot);
+                row->clickListener = [&table, begin](u64) { return begin < table.size(); };
+            }
+        }
+        bench::AllocStats used = bench::allocDelta(start);
+
+        for (auto *row : rows)
+            delete row;
+        return used;
+    }
+
+    bool parseArgs(int argc, char **argv, Config &config) {
+        for (int i = 1; i < argc; i++) {
+            if (i + 1 >= argc)
+                return false;
+            if (std::strcmp(argv[i], "--modules") == 0)
+                config.corpus.titles = std::strtoul(argv[++i], nullptr, 0);
+            else if (std::strcmp(argv[i], "--seed") == 0)
+                config.corpus.seed = std::strtoull(argv[++i], nullptr, 0);
+            else if (std::strcmp(argv[i], "--toolbox-size") == 0)
+                config.corpus.toolboxMinSize = config.corpus.toolboxMaxSize = std::strtoul(argv[++i], nullptr, 0);
+            else if (std::strcmp(argv[i], "--toolbox-max") == 0)
+                config.corpus.toolboxMaxSize = std::strtoul(argv[++i], nullptr, 0);
+            else if (std::strcmp(argv[i], "--sxos") == 0)
+                config.corpus.sxosPercent = std::strtoul(argv[++i], nullptr, 0);
+            else if (std::strcmp(argv[i], "--junk-dirs") == 0)
+                config.corpus.junkDirectories = std::strtoul(argv[++i], nullptr, 0);
+            else if (std::strcmp(argv[i], "--malformed") == 0)
+                config.corpus.malformedPercent = std::strtoul(argv[++i], nullptr, 0);
+            else if (std::strcmp(argv[i], "--copy-size") == 0)
+                config.corpus.bootPayloads = { { "/bootloader/boot-sxos.dat", std::strtoul(argv[++i], nullptr, 0) }, { "/boot.dat", 0 } };
+            else if (std::strcmp(argv[i], "--iterations") == 0)
+                config.iterations = std::max<u32>(1, std::strtoul(argv[++i], nullptr, 0));
+            else if (std::strcmp(argv[i], "--list-modules") == 0)
+                config.listModules = std::strtoul(argv[++i], nullptr, 0);
+            else if (std::strcmp(argv[i], "--table-modules") == 0)
+                config.tableModules = std::strtoul(argv[++i], nullptr, 0);
+            else if (std::strcmp(argv[i], "--only") == 0)
+                config.only = argv[++i];
+            else if (std::strcmp(argv[i], "--scan-latency") == 0)
+                config.scanLatencyNs = std::strtoull(argv[++i], nullptr, 0);
+            else if (std::strcmp(argv[i], "--latency") == 0)
+                config.latency.latencyNs = std::strtoull(argv[++i], nullptr, 0);
+            else if (std::strcmp(argv[i], "--jitter") == 0)
+                config.latency.jitterNs = std::strtoull(argv[++i], nullptr, 0);
+            else if (std::strcmp(argv[i], "--fault") == 0) {
+                if (!parseFault(argv[++i], config))
+                    return false;
+            }
+            else
+                return false;
+        }
+        return true;
+    }
+
+}
+
+int main(int argc, char **argv) {
+    Config config;
+    if (!parseArgs(argc, argv, config)) {
+        std::fprintf(stderr, "usage: %s [--modules N] [--seed N] [--toolbox-size BYTES] [--toolbox-max BYTES] [--malformed PERCENT] [--junk-dirs N]\n"
+                             "       [--sxos PERCENT]\n"
+                             "       [--copy-size BYTES] [--iterations N] [--only NAME] [--latency NS] [--jitter NS]\n"
+                             "       [--fault CALL:PERCENT:RESULT[:PATH]]... [--list-modules N] [--table-modules N] [--scan-latency NS]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    corpus::Manifest manifest = corpus::generateFake(config.corpus);
+    const u32 directories = manifest.titles.size() + manifest.junkDirectories.size();
+    const u32 titles = manifest.titles.size();
+    const u32 copySize = config.corpus.bootPayloads.front().second;
+
+    FsFileSystem fs;
+    fsOpenSdCardFileSystem(&fs);
+    LibnxBackend backend;
+    backend.initialize();
+
+    std::vector<u64> programIds;
+    std::vector<std::string> toolboxes;
+    for (const auto *title : manifest.listed()) {
+        char path[FS_MAX_PATH];
+        programIds.push_back(title->programId);
+        std::snprintf(path, FS_MAX_PATH, "/atmosphere/contents/%016lX/toolbox.json", title->programId);
+        fake::readFile(path, toolboxes.emplace_back());
+    }
+
+    /* Injected after the corpus is read back so only the benchmarked calls are slowed down. */
+    auto injectFaults = [&](const fake::Fault &latency) {
+        fake::clearFaults();
+        if (latency.latencyNs > 0 || latency.jitterNs > 0) {
+            for (u32 call = 0; call < u32(fake::Call::Count); call++)
+                fake::setFault(fake::Call(call), latency);
+        }
+        for (const auto &[call, fault] : config.faults) {
+            fake::Fault combined = fault;
+            combined.latencyNs = latency.latencyNs;
+            combined.jitterNs = latency.jitterNs;
+            fake::setFault(call, combined);
+        }
+        fake::setFaultSeed(config.corpus.seed);
+    };
+    injectFaults(config.latency);
+
+    std::vector<bench::Result> results;
+    auto enabled = [&](const char *name) { return config.only == nullptr || std::strcmp(config.only, name) == 0; };
+
+    if (enabled("dir_iterate")) {
+        results.push_back(bench::run("dir_iterate", config.iterations, directories, 0, [&] {
+            FsDir dir;
+            if (R_FAILED(fsFsOpenDirectory(&fs, "/atmosphere/contents", FsDirOpenMode_ReadDirs, &dir)))
+                return directories;
+            u32 count = 0;
+            for (const auto &entry : FsDirIterator(dir))
+                count += entry.name[0] != '\0';
+            fsDirClose(&dir);
+            return directories - count;
+        }));
+    }
+
+    if (enabled("toolbox_parse")) {
+        results.push_back(bench::run("toolbox_parse_legacy", config.iterations, toolboxes.size(), 0, [&] {
+            legacy::ToolboxInfo info;
+            u32 errors = 0;
+            for (const auto &data : toolboxes)
+                errors += !legacy::parseToolbox(data, info);
+            return errors;
+        }));
+        results.push_back(bench::run("toolbox_parse", config.iterations, toolboxes.size(), 0, [&] {
+            ToolboxInfo info;
+            u32 errors = 0;
+            for (const auto &data : toolboxes)
+                errors += !parseToolbox(data, info);
+            return errors;
+        }));
+    }
+
+    if (enabled("program_id_parse")) {
+        /* Ids as they appear in toolbox.json, parsed the way the DOM code did and with parseProgramId. */
+        std::vector<std::string> tids;
+        for (u64 programId : programIds) {
+            char tid[ProgramIdLength + 1];
+            std::snprintf(tid, sizeof(tid), "%016lX", programId);
+            tids.emplace_back(tid);
+        }
+
+        results.push_back(bench::run("program_id_parse_strtoul", config.iterations, tids.size(), 0, [&] {
+            u64 sum = 0;
+            for (const auto &tid : tids) {
+                std::string copy = tid;
+                sum += std::strtoul(copy.c_str(), nullptr, 16);
+            }
+            bench::consume(sum);
+            return 0;
+        }));
+        results.push_back(bench::run("program_id_parse", config.iterations, tids.size(), 0, [&] {
+            u64 sum = 0;
+            u32 errors = 0;
+            for (const auto &tid : tids) {
+                u64 programId = 0;
+                errors += !parseProgramId(tid, programId);
+                sum += programId;
+            }
+            bench::consume(sum);
+            return errors;
+        }));
+    }
+
+    /* Both scans should find exactly the listed modules. */
+    auto scanErrors = [&](size_t found) {
+        return u32(found > programIds.size() ? found - programIds.size() : programIds.size() - found);
+    };
+
+    if (enabled("scan")) {
+        results.push_back(bench::run("scan_legacy", config.iterations, titles, 0, [&] {
+            std::list<legacy::ToolboxInfo> modules;
+            if (R_FAILED(legacy::scanModules(&fs, modules)))
+                return titles;
+            return scanErrors(modules.size());
+        }));
+        results.push_back(bench::run("scan", config.iterations, titles, 0, [&] {
+            ScanArena arena;
+            ModuleTable table;
+            if (R_FAILED(scanModules(&fs, arena, table, nullptr)))
+                return titles;
+            return scanErrors(table.size());
+        }));
+        /* The warmup run writes the index, the timed runs all start from an up to date one. */
+        results.push_back(bench::run("scan_indexed", config.iterations, titles, 0, [&] {
+            ScanArena arena;
+            ModuleTable table;
+            if (R_FAILED(scanModules(&fs, arena, table, ScanIndexPath)))
+                return titles;
+            return scanErrors(table.size());
+        }));
+    }
+
+    /* Scans with every worker count on a card that answers slowly, compared against a serial scan without latency. */
+    nlohmann::json parallel = nlohmann::json::array();
+    if (enabled("scan_parallel")) {
+        ScanArena referenceArena;
+        ModuleTable reference;
+        scanModules(&fs, referenceArena, reference, nullptr, 1);
+        auto mismatches = [&](const ModuleTable &table) {
+            if (table.size() != reference.size())
+                return reference.size();
+            u32 count = 0;
+            for (u32 i = 0; i < table.size(); i++)
+                count += table.programId(i) != reference.programId(i) || table.name(i) != reference.name(i) || table.needReboot(i) != reference.needReboot(i) || table.rootIndex(i) != reference.rootIndex(i);
+            return count;
+        };
+
+        fake::Fault latency = config.latency;
+        latency.latencyNs = std::max(latency.latencyNs, config.scanLatencyNs);
+        injectFaults(latency);
+
+        u64 serialNs = 0;
+        for (u32 workers = 1; workers <= WorkPool::MaxWorkers; workers++) {
+            char name[32];
+            std::snprintf(name, sizeof(name), "scan_workers_%u", workers);
+            bench::Result result = bench::run(name, config.iterations, titles, 0, [&] {
+                ScanArena arena;
+                ModuleTable table;
+                if (R_FAILED(scanModules(&fs, arena, table, nullptr, workers)))
+                    return reference.size();
+                return mismatches(table);
+            });
+            if (workers == 1)
+                serialNs = result.nsMedian;
+            parallel.push_back({ {"workers", workers}, {"latency_ns", latency.latencyNs}, {"ns_median", result.nsMedian}, {"ns_min", result.nsMin},
+                                 {"speedup", result.nsMedian > 0 ? double(serialNs) / result.nsMedian : 0.0}, {"mismatches", result.errors} });
+            results.push_back(std::move(result));
+        }
+
+        injectFaults(config.latency);
+    }
+
+    if (enabled("rescan") && !programIds.empty()) {
+        ScanArena arena;
+        ModuleTable table;
+        ScanState state;
+        scanModules(&fs, arena, table, state, nullptr);
+
+        results.push_back(bench::run("rescan_check", config.iterations, titles, 0, [&] {
+            TitleListing listing;
+            return R_FAILED(listTitles(&fs, listing)) || listing != state.listing ? 1 : 0;
+        }));
+
+        /* Every run rewrites one toolbox.json, the rescan has to pick up exactly that one and reuse the rest. */
+        char path[FS_MAX_PATH];
+        std::snprintf(path, FS_MAX_PATH, "/atmosphere/contents/%016lX/toolbox.json", programIds.front());
+        results.push_back(bench::run("rescan_one_changed", config.iterations, titles, 0, [&] {
+            fake::writeFile(path, toolboxes.front());
+            ScanArena rescanArena;
+            ModuleTable rescanTable;
+            ScanState rescanState = state;
+            /* The listing has to notice the rewritten file, or the overlay would never rescan. */
+            TitleListing listing;
+            if (R_FAILED(listTitles(&fs, listing)) || R_FAILED(scanModules(&fs, rescanArena, rescanTable, rescanState, nullptr)))
+                return titles;
+            return (listing == state.listing) + (listing != rescanState.listing) + (rescanState.changed && rescanTable.size() == table.size() ? 0u : 1u);
+        }));
+    }
+
+    if (enabled("usage_sample")) {
+        ScanArena arena;
+        ModuleTable table;
+        if (R_SUCCEEDED(scanModules(&fs, arena, table, nullptr))) {
+            /* Errors are modules whose sampled usage doesn't match what the corpus gave their process. */
+            auto mismatches = [&] {
+                u32 count = 0;
+                for (u32 i = 0; i < table.size(); i++) {
+                    const corpus::Title *title = nullptr;
+                    for (const auto *listed : manifest.listed()) {
+                        if (listed->programId == table.programId(i))
+                            title = listed;
+                    }
+                    const u64 expected = title != nullptr && title->running ? title->memoryUsage : 0;
+                    count += table.memoryUsage(i) != expected || table.running(i) != (expected > 0);
+                }
+                return count;
+            };
+
+            UsageSampler sampler;
+            results.push_back(bench::run("usage_sample", config.iterations, table.size(), 0, [&] {
+                sampler.invalidate();
+                sampler.sample(table, backend);
+                return 0;
+            }));
+            results.back().errors = mismatches();
+            /* Within the interval, which is what most frames see. */
+            results.push_back(bench::run("usage_sample_cached", config.iterations, table.size(), 0, [&] {
+                return sampler.sample(table, backend) ? 1 : 0;
+            }));
+
+            /* Every process info query fails. Errors are modules whose running state changed or whose usage isn't unknown while running. */
+            fake::Fault failing = config.latency;
+            failing.errorPercent = 100;
+            failing.error = MAKERESULT(Module_Kernel, 1);
+            fake::setFault(fake::Call::GetProcessInfo, failing);
+            results.push_back(bench::run("usage_sample_failing", config.iterations, table.size(), 0, [&] {
+                sampler.invalidate();
+                sampler.sample(table, backend);
+                return 0;
+            }));
+            u32 failingErrors = 0;
+            for (u32 i = 0; i < table.size(); i++)
+                failingErrors += table.running(i) != fake::isRunning(table.programId(i)) ||
+                                 (table.memoryUsage(i) == ModuleTable::UnknownMemoryUsage) != table.running(i);
+            results.back().errors = failingErrors;
+            injectFaults(config.latency);
+            sampler.invalidate();
+            sampler.sample(table, backend);
+        }
+    }
+
+    if (enabled("memory_budget")) {
+        ScanArena arena;
+        ModuleTable table;
+        if (R_SUCCEEDED(scanModules(&fs, arena, table, nullptr))) {
+            UsageSampler sampler;
+            sampler.sample(table, backend);
+
+            /* Selecting and deselecting every module, each one adjusts the totals by itself. */
+            results.push_back(bench::run("memory_budget_select", config.iterations, table.size(), 0, [&] {
+                for (u32 i = 0; i < table.size(); i++)
+                    table.setSelected(i, true);
+                const u64 selected = table.selectedMemoryUsage();
+                for (u32 i = 0; i < table.size(); i++)
+                    table.setSelected(i, false);
+                return selected == table.totalMemoryUsage() && table.selectedMemoryUsage() == 0 ? 0u : 1u;
+            }));
+
+            /* The estimate for every other running module has to be what stopping them actually frees in the pool. */
+            for (u32 i = 0; i < table.size(); i += 2)
+                table.setSelected(i, true);
+            const u64 estimate = table.selectedMemoryUsage(), usedBefore = sampler.poolUsed();
+            for (u32 i = 0; i < table.size(); i += 2)
+                pmshellTerminateProgram(table.programId(i));
+            sampler.invalidate();
+            sampler.sample(table, backend);
+            results.push_back(bench::Result{ .name = "memory_budget_estimate", .iterations = 1, .items = table.selectedCount(),
+                                             .errors = usedBefore - sampler.poolUsed() == estimate ? 0u : 1u });
+            for (const auto *title : manifest.listed())
+                fake::setRunning(title->programId, title->running);
+        }
+    }
+
+    if (enabled("engine_toggle")) {
+        /* Stops and starts every dynamic module through the engine, errors are toggles that didn't change whether it runs. */
+        auto toggleAll = [&](const char *name, Backend &backend) {
+            ModuleEngine engine(backend);
+            if (R_FAILED(engine.initialize()))
+                return;
+            const ModuleTable &modules = engine.modules();
+            std::vector<std::pair<bool, bool>> before;
+            for (u32 i = 0; i < modules.dynamicCount(); i++)
+                before.emplace_back(backend.isRunning(modules.programId(i)), backend.fileExists(modules.boot2FlagPath(i)));
+
+            results.push_back(bench::run(name, config.iterations, modules.dynamicCount() * 2, 0, [&] {
+                u32 errors = 0;
+                for (u32 i = 0; i < modules.dynamicCount(); i++) {
+                    const bool running = backend.isRunning(modules.programId(i));
+                    engine.toggleRunning(i);
+                    errors += backend.isRunning(modules.programId(i)) == running;
+                    engine.toggleRunning(i);
+                }
+                return errors;
+            }));
+
+            /* Toggling twice leaves a flag behind, the benchmarks after this one expect the corpus as generated. */
+            for (u32 i = 0; i < modules.dynamicCount(); i++) {
+                const auto [running, hasFlag] = before[i];
+                if (backend.isRunning(modules.programId(i)) != running)
+                    running ? backend.launchProgram(modules.programId(i)) : backend.terminateProgram(modules.programId(i));
+                if (backend.fileExists(modules.boot2FlagPath(i)) != hasFlag)
+                    hasFlag ? backend.createFile(modules.boot2FlagPath(i)) : backend.deleteFile(modules.boot2FlagPath(i));
+            }
+        };
+        toggleAll("engine_toggle", backend);
+
+        /* The same logic without the fake libnx underneath, what's left is the engine itself. */
+        MemoryBackend memory;
+        for (const auto *title : manifest.listed()) {
+            /* Modules found through their exefs are static, like the scan lists them. */
+            const bool needReboot = title->needReboot || title->toolbox != corpus::ToolboxKind::Valid;
+            memory.addModule({ .programId = title->programId, .name = title->name, .root = 0, .needReboot = needReboot, .memoryUsage = title->memoryUsage });
+            memory.setRunning(title->programId, title->running);
+        }
+        toggleAll("engine_toggle_memory", memory);
+    }
+
+    /* Up to eight running dynamic modules, stopped and started again by profiles like a hotkey would. */
+    std::vector<u64> headlessIds;
+    for (const auto *title : manifest.listed()) {
+        if (title->running && !title->needReboot && title->toolbox == corpus::ToolboxKind::Valid && headlessIds.size() < 8)
+            headlessIds.push_back(title->programId);
+    }
+    auto writeProfile = [&](const char *name, const char *verb) {
+        std::string profile = "# written by the benchmark\n";
+        for (u64 programId : headlessIds) {
+            char line[32];
+            std::snprintf(line, sizeof(line), "%s %016lX\n", verb, programId);
+            profile += line;
+        }
+        fake::writeFile(std::string(ProfileDirectory) + "/" + name + ".txt", profile);
+    };
+    writeProfile("bench_stop", "stop");
+    writeProfile("bench_start", "start");
+    char headlessStopId[ProgramIdLength + 1] = {};
+    if (!headlessIds.empty())
+        formatProgramId(headlessIds.front(), headlessStopId);
+    /* The stop parses, the line after it doesn't, so the profile isn't applied at all. */
+    fake::writeFile(std::string(ProfileDirectory) + "/bench_broken.txt", std::string("stop ") + headlessStopId + "\nrestart " + headlessStopId + "\n");
+    char arg0[] = "ovlSysmodules", profileArg[] = "--profile", stopArg[] = "--stop", startArg[] = "--start";
+    char stopProfile[] = "bench_stop", startProfile[] = "bench_start", brokenProfile[] = "bench_broken";
+    char *profileStop[] = { arg0, profileArg, stopProfile }, *profileStart[] = { arg0, profileArg, startProfile }, *profileBroken[] = { arg0, profileArg, brokenProfile };
+    char *stopOne[] = { arg0, stopArg, headlessStopId }, *startOne[] = { arg0, startArg, headlessStopId };
+    char unknownArg[] = "--restart";
+    char *missingValue[] = { arg0, stopArg, headlessStopId, startArg }, *unknownFlag[] = { arg0, unknownArg, headlessStopId };
+
+    if (enabled("headless") && !headlessIds.empty()) {
+        /* Errors are actions that failed and modules left in the wrong state. */
+        auto stillRunning = [&](bool expected) {
+            u32 count = 0;
+            for (u64 programId : headlessIds)
+                count += fake::isRunning(programId) != expected;
+            return count;
+        };
+        results.push_back(bench::run("headless_profile", config.iterations, headlessIds.size() * 2, 0, [&] {
+            u32 errors = runHeadless(backend, 3, profileStop) + stillRunning(false);
+            return errors + runHeadless(backend, 3, profileStart) + stillRunning(true);
+        }));
+        results.push_back(bench::run("headless_stop", config.iterations, 2, 0, [&] {
+            u32 errors = runHeadless(backend, 3, stopOne) + fake::isRunning(headlessIds.front());
+            return errors + runHeadless(backend, 3, startOne) + !fake::isRunning(headlessIds.front());
+        }));
+        /* A trailing flag without its value or an unknown one is refused as a whole, the module named before it keeps running. */
+        results.push_back(bench::run("headless_usage", config.iterations, 2, 0, [&] {
+            u32 errors = (runHeadless(backend, 4, missingValue) != HeadlessUsageError) + (runHeadless(backend, 3, unknownFlag) != HeadlessUsageError);
+            return errors + !fake::isRunning(headlessIds.front());
+        }));
+        results.push_back(bench::run("headless_broken_profile", config.iterations, 1, 0, [&] {
+            return (runHeadless(backend, 3, profileBroken) != 1) + !fake::isRunning(headlessIds.front());
+        }));
+    }
+
+    if (enabled("headless_dependencies")) {
+        /*
+         * A module with more dependencies than MaxHeadlessModules has room for,
+         * none of them running. Each one that doesn't fit counts as a failure
+         * of its own besides the module, and nothing is started.
+         */
+        constexpr u32 dependencyCount = MaxHeadlessModules + 2;
+        MemoryBackend memory;
+        MemoryBackend::Module module = { .programId = 0x4200000000D00000, .name = "wide", .root = 0, .needReboot = false, .memoryUsage = 0x100000 };
+        for (u32 i = 1; i <= dependencyCount; i++) {
+            memory.addModule({ .programId = module.programId + i, .name = "dependency", .root = 0, .needReboot = false, .memoryUsage = 0x100000 });
+            module.dependencies.push_back(module.programId + i);
+        }
+        memory.addModule(module);
+        char wideId[ProgramIdLength + 1] = {};
+        formatProgramId(module.programId, wideId);
+        char *startWide[] = { arg0, startArg, wideId };
+        const u32 expected = 1 + dependencyCount - (MaxHeadlessModules - 1);
+        results.push_back(bench::run("headless_dependencies", config.iterations, 1, 0, [&] {
+            u32 errors = runHeadless(memory, 3, startWide) != expected;
+            for (u32 i = 0; i <= dependencyCount; i++)
+                errors += memory.isRunning(module.programId + i);
+            return errors;
+        }));
+    }
+
+    if (enabled("batch_start")) {
+        /*
+         * 64 modules in eight layers, each depending on one or two modules of
+         * the layer below, launched with --scan-latency per launch. Errors are
+         * launches before a dependency ran plus modules the batch failed on.
+         */
+        constexpr u32 layers = 8, width = 8;
+        MemoryBackend memory;
+        memory.setLaunchLatency(config.scanLatencyNs);
+        std::vector<u64> layered;
+        for (u32 layer = 0; layer < layers; layer++) {
+            for (u32 i = 0; i < width; i++) {
+                MemoryBackend::Module module = { .programId = 0x4200000000B00000 + u64(layer * width + i), .name = "layer " + std::to_string(layer),
+                                                 .root = 0, .needReboot = false, .memoryUsage = 0x100000 };
+                if (layer > 0) {
+                    module.dependencies.push_back(layered[(layer - 1) * width + i]);
+                    if (i % 2 == 0)
+                        module.dependencies.push_back(layered[(layer - 1) * width + (i + 1) % width]);
+                }
+                memory.addModule(module);
+                layered.push_back(module.programId);
+            }
+        }
+
+        ModuleEngine engine(memory);
+        if (R_SUCCEEDED(engine.initialize())) {
+            /* Only the top layer is asked for, the rest comes in as dependencies. */
+            std::vector<u32> top, all(engine.modules().size());
+            for (u32 i = 0; i < all.size(); i++) {
+                all[i] = i;
+                if (engine.modules().programId(i) >= layered[(layers - 1) * width])
+                    top.push_back(i);
+            }
+            /*
+             * With alreadyRunning, every other top module is up before the batch and only the rest
+             * bring up their dependencies, which still have to start first.
+             */
+            auto batch = [&](const char *name, u32 workers, bool alreadyRunning) {
+                results.push_back(bench::run(name, config.iterations, layered.size(), 0, [&] {
+                    for (u32 i = 0; alreadyRunning && i < top.size(); i += 2)
+                        memory.setRunning(engine.modules().programId(top[i]), true);
+                    const u32 violations = memory.orderViolations();
+                    const ModuleEngine::BatchResult started = engine.startModules(top.data(), top.size(), nullptr, workers);
+                    const u32 running = std::count_if(layered.begin(), layered.end(), [&](u64 programId) { return memory.isRunning(programId); });
+                    const ModuleEngine::BatchResult stopped = engine.stopModules(all.data(), all.size(), nullptr, workers);
+                    return memory.orderViolations() - violations + started.failed + stopped.failed +
+                           (started.changed != (alreadyRunning ? running - width / 2 : layered.size())) + (stopped.changed != running);
+                }));
+            };
+            batch("batch_start", ModuleEngine::BatchWorkers, false);
+            batch("batch_start_serial", 1, false);
+            batch("batch_start_running", ModuleEngine::BatchWorkers, true);
+        }
+    }
+
+    if (enabled("launch_watch")) {
+        /*
+         * 16 modules started at once and watched for 20 ms, every fourth one
+         * exits 2 ms after its launch. Errors are modules the tracker didn't
+         * report the way they behaved, the items are launches.
+         */
+        constexpr u32 count = 16;
+        MemoryBackend memory;
+        for (u32 i = 0; i < count; i++)
+            memory.addModule({ .programId = 0x4200000000C00000 + u64(i), .name = "watched", .root = 0, .needReboot = false, .memoryUsage = 0x100000,
+                               .exitAfterNs = i % 4 == 0 ? 2'000'000u : 0u });
+
+        ModuleEngine engine(memory, UsageSampler::DefaultIntervalNs, 20'000'000);
+        if (R_SUCCEEDED(engine.initialize())) {
+            std::vector<u32> all(engine.modules().size());
+            for (u32 i = 0; i < all.size(); i++)
+                all[i] = i;
+            results.push_back(bench::run("launch_watch", config.iterations, count, 0, [&] {
+                u32 errors = engine.startModules(all.data(), all.size()).failed;
+                while (engine.launches().watching()) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    engine.pollLaunches();
+                }
+                for (u32 i = 0; i < all.size(); i++) {
+                    const u64 programId = engine.modules().programId(i);
+                    const LaunchTracker::Record *record = engine.launches().find(programId);
+                    const auto expected = (programId & 0xFFFF) % 4 == 0 ? LaunchTracker::Outcome::ExitedEarly : LaunchTracker::Outcome::Running;
+                    errors += record == nullptr || record->outcome != expected || engine.modules().running(i) != (expected == LaunchTracker::Outcome::Running);
+                }
+                engine.stopModules(all.data(), all.size());
+                return errors;
+            }));
+
+            /* Stopped right after starting, inside the window. Errors are modules that came out as anything but stopped, or as an early exit. */
+            results.push_back(bench::run("launch_stop", config.iterations, count, 0, [&] {
+                u32 earlyExits = 0;
+                for (u32 i = 0; i < engine.launches().count(); i++)
+                    earlyExits += engine.launches().records()[i].earlyExits;
+                u32 errors = engine.startModules(all.data(), all.size()).failed + engine.stopModules(all.data(), all.size()).failed;
+                errors += engine.launches().watching();
+                engine.pollLaunches();
+                for (u32 i = 0; i < engine.launches().count(); i++) {
+                    const LaunchTracker::Record &record = engine.launches().records()[i];
+                    errors += record.outcome != LaunchTracker::Outcome::Stopped;
+                    earlyExits -= record.earlyExits;
+                }
+                for (u32 i = 0; i < all.size(); i++)
+                    errors += engine.modules().running(i);
+                return errors + (earlyExits != 0);
+            }));
+        }
+    }
+
+    if (enabled("journal")) {
+        /* What recording adds to every start, stop and flag change. */
+        EventJournal journal;
+        results.push_back(bench::run("journal_record", config.iterations, EventJournal::Capacity, 0, [&] {
+            for (u32 i = 0; i < EventJournal::Capacity; i++) {
+                const u64 start = armGetSystemTick();
+                journal.record(JournalAction::Start, 0x4200000000000000 + i, 0, start, armGetSystemTick());
+            }
+            return 0;
+        }));
+
+        /* A full buffer appended to the journal on the fake SD card, errors are lines that didn't make it. */
+        results.push_back(bench::run("journal_flush", config.iterations, EventJournal::Capacity, 0, [&] {
+            backend.deleteFile(JournalPath);
+            for (u32 i = 0; i < EventJournal::Capacity; i++)
+                journal.record(JournalAction::Stop, 0x4200000000000000 + i, 0, 0, 0);
+            u32 errors = R_FAILED(journal.flush(backend, JournalPath));
+            std::string written;
+            fake::readFile(JournalPath, written);
+            const u32 lines = std::count(written.begin(), written.end(), '\n');
+            return errors + (lines > EventJournal::Capacity ? lines - EventJournal::Capacity : EventJournal::Capacity - lines);
+        }));
+        backend.deleteFile(JournalPath);
+    }
+
+    if (enabled("frame_profiler")) {
+        /*
+         * What the strip costs per frame while it's shown: recording a frame
+         * and summarizing the history. Frames take 1 to 128 ms, one each, so
+         * errors are percentiles that aren't the 64th and 126th frame.
+         */
+        FrameProfiler profiler;
+        profiler.setEnabled(true);
+        u64 frame = 0;
+        results.push_back(bench::run("frame_profiler", config.iterations, FrameProfiler::Frames, 0, [&] {
+            u32 errors = 0;
+            for (u32 i = 0; i < FrameProfiler::Frames; i++, frame++) {
+                profiler.recordUpdate(armNsToTicks(1'000'000));
+                profiler.recordDraw(armNsToTicks((frame * 37 % FrameProfiler::Frames) * 1'000'000));
+                const FrameProfiler::Summary summary = profiler.summarize();
+                bench::consume(summary.p99Ns);
+                if (profiler.count() == FrameProfiler::Frames && i == FrameProfiler::Frames - 1)
+                    errors += (summary.p50Ns + 500'000) / 1'000'000 != 64 || (summary.p99Ns + 500'000) / 1'000'000 != 126;
+            }
+            return errors;
+        }));
+    }
+
+    if (enabled("status_poll")) {
+        /* Paths formatted on every poll, as before they were precomputed by the scan. */
+        results.push_back(bench::run("status_poll_format", config.iterations, programIds.size(), 0, [&] {
+            u32 states = 0;
+            char path[FS_MAX_PATH];
+            for (u64 programId : programIds) {
+                formatFlagPath(path, ContentRoots[0], programId);
+                states += isProgramRunning(programId) + fileExists(&fs, path);
+            }
+            bench::consume(states);
+            return 0;
+        }));
+
+        ScanArena arena;
+        ModuleTable table;
+        if (R_SUCCEEDED(scanModules(&fs, arena, table, nullptr))) {
+            results.push_back(bench::run("status_poll", config.iterations, table.size(), 0, [&] {
+                u32 states = 0;
+                for (u32 i = 0; i < table.size(); i++)
+                    states += isProgramRunning(table.programId(i)) + fileExists(&fs, table.boot2FlagPath(i));
+                bench::consume(states);
+                return 0;
+            }));
+        }
+    }
+
+    if (enabled("copy_file")) {
+        results.push_back(bench::run("copy_file", config.iterations, 0, copySize, [&] {
+            return R_FAILED(CopyFile(&fs, "/bootloader/boot-sxos.dat", "/boot.dat")) ? 1 : 0;
+        }));
+    }
+
+    if (enabled("list_scroll")) {
+        /* Scrolls a virtual list from top to bottom and back, rebinding rows as they enter the window. */
+        results.push_back(bench::run("list_scroll", config.iterations, 2 * config.listModules, 0, [&] {
+            RowWindow window(5, 2);
+            window.setCount(config.listModules);
+            std::vector<u32> slots(window.poolSize(), ~0u);
+            u32 rebinds = 0;
+            auto step = [&](u32 index) {
+                if (!window.moveTo(index))
+                    return;
+                for (u32 i = window.boundBegin(); i < window.boundEnd(); i++) {
+                    u32 &slot = slots[window.slotOf(i)];
+                    rebinds += slot != i;
+                    slot = i;
+                }
+            };
+            for (u32 i = 0; i < config.listModules; i++)
+                step(i);
+            for (u32 i = config.listModules; i > 0; i--)
+                step(i - 1);
+            bench::consume(rebinds);
+            return 0;
+        }));
+    }
+
+    if (enabled("module_iterate") || enabled("module_status_update") || enabled("search")) {
+        /* The std::list<SystemModule> the overlay used before the module table, walked the same way. */
+        struct ListedModule {
+            void *listItem;
+            u64 programId;
+            bool needReboot;
+            bool running;
+            bool hasFlag;
+        };
+        std::list<ListedModule> list;
+        for (u32 i = 0; i < config.tableModules; i++) {
+            u64 programId = 0x0100000000001000ULL + i;
+            list.push_back({ nullptr, programId, i % 3 == 0, false, false });
+            fake::setRunning(programId, i % 2 == 0);
+        }
+        ScanArena arena;
+        ModuleTable table = buildTable(arena, config.tableModules);
+
+        if (enabled("module_iterate")) {
+            /* createUI visits the dynamic modules first and the static ones second. */
+            results.push_back(bench::run("module_iterate_list", config.iterations, config.tableModules, 0, [&] {
+                u64 sum = 0;
+                for (const auto &module : list) {
+                    if (!module.needReboot)
+                        sum += module.programId;
+                }
+                for (const auto &module : list) {
+                    if (module.needReboot)
+                        sum += module.programId;
+                }
+                bench::consume(sum);
+                return 0;
+            }));
+            results.push_back(bench::run("module_iterate_table", config.iterations, config.tableModules, 0, [&] {
+                u64 sum = 0;
+                const u64 *programIds = table.programIds();
+                for (u32 i = 0; i < table.dynamicCount(); i++)
+                    sum += programIds[i];
+                for (u32 i = table.staticBegin(); i < table.size(); i++)
+                    sum += programIds[i];
+                bench::consume(sum);
+                return 0;
+            }));
+        }
+
+        if (enabled("module_status_update")) {
+            results.push_back(bench::run("module_status_update_list", config.iterations, config.tableModules, 0, [&] {
+                char path[FS_MAX_PATH];
+                for (auto &module : list) {
+                    formatFlagPath(path, ContentRoots[0], module.programId);
+                    module.running = isProgramRunning(module.programId);
+                    module.hasFlag = fileExists(&fs, path);
+                }
+                return 0;
+            }));
+            results.push_back(bench::run("module_status_update_table", config.iterations, config.tableModules, 0, [&] {
+                for (u32 i = 0; i < table.size(); i++)
+                    table.setState(i, isProgramRunning(table.programId(i)), fileExists(&fs, table.boot2FlagPath(i)));
+                return 0;
+            }));
+        }
+
+        if (enabled("search")) {
+            /*
+             * One keystroke each: the modules matching a query, found by
+             * lowercasing and walking every name and program id, and through
+             * the prefix index. Errors are queries the two disagree on, the
+             * index lists modules by the key they matched so the results are
+             * compared as sets, outside the timed runs.
+             */
+            constexpr std::string_view queries[] = { "s", "sys", "synthetic sysmodule #1", "0", "1", "12", "0100000000001", "#", "x" };
+            std::vector<u32> linear(table.size()), indexed(table.size());
+            std::vector<std::vector<u32>> expected;
+            auto matchLinear = [&](std::string_view query, u32 *out) -> u32 {
+                u32 count = 0;
+                for (u32 module = 0; module < table.size(); module++) {
+                    std::string name(table.name(module));
+                    char programId[ProgramIdLength];
+                    formatProgramId(table.programId(module), programId);
+                    for (char &c : name)
+                        c = std::tolower(c);
+                    for (char &c : programId)
+                        c = std::tolower(c);
+                    bool match = std::string_view(programId, ProgramIdLength).starts_with(query);
+                    for (u32 i = 0; i < name.size() && !match; i++) {
+                        const bool wordStart = i == 0 || (std::isalnum(name[i]) && !std::isalnum(name[i - 1]));
+                        match = wordStart && std::string_view(name).substr(i).starts_with(query);
+                    }
+                    if (match)
+                        out[count++] = module;
+                }
+                return count;
+            };
+
+            results.push_back(bench::run("search_linear", config.iterations, std::size(queries), 0, [&] {
+                for (std::string_view query : queries)
+                    bench::consume(matchLinear(query, linear.data()));
+                return 0;
+            }));
+
+            for (std::string_view query : queries)
+                expected.emplace_back(linear.begin(), linear.begin() + matchLinear(query, linear.data()));
+            ModuleSearch search;
+            search.build(table, arena);
+            u32 mismatches = 0;
+            for (u32 i = 0; i < std::size(queries); i++) {
+                const u32 count = search.find(queries[i], indexed.data(), indexed.size());
+                std::sort(indexed.begin(), indexed.begin() + count);
+                mismatches += !std::equal(indexed.begin(), indexed.begin() + count, expected[i].begin(), expected[i].end());
+            }
+            results.push_back(bench::run("search_prefix", config.iterations, std::size(queries), 0, [&] {
+                for (std::string_view query : queries)
+                    bench::consume(search.find(query, indexed.data(), indexed.size()));
+                return mismatches;
+            }));
+        }
+
+        for (u32 i = 0; i < config.tableModules; i++)
+            fake::setRunning(0x0100000000001000ULL + i, false);
+    }
+
+    /* Filesystem calls made by a single scan, the fake counts them as they come in. */
+    nlohmann::json io = nlohmann::json::array();
+    if (enabled("scan_io")) {
+        auto report = [&](const char *name) {
+            nlohmann::json calls = { {"name", name} };
+            for (fake::Call call : { fake::Call::OpenDirectory, fake::Call::OpenFile, fake::Call::ReadFile, fake::Call::GetFileSize, fake::Call::GetTimeStamp })
+                calls[std::string(fake::callName(call))] = fake::callCount(call);
+            io.push_back(calls);
+        };
+
+        fake::resetCallCounts();
+        std::list<legacy::ToolboxInfo> modules;
+        legacy::scanModules(&fs, modules);
+        report("scan_legacy");
+
+        auto scan = [&](const char *name, const char *indexPath) {
+            fake::resetCallCounts();
+            ScanArena arena;
+            ModuleTable table;
+            scanModules(&fs, arena, table, indexPath);
+            report(name);
+        };
+        scan("scan", nullptr);
+        fsFsDeleteFile(&fs, ScanIndexPath);
+        scan("scan_index_cold", ScanIndexPath);
+        scan("scan_indexed", ScanIndexPath);
+
+        /* A hotkey only reads the modules it names. */
+        if (!headlessIds.empty()) {
+            fake::resetCallCounts();
+            runHeadless(backend, 3, stopOne);
+            report("headless_stop");
+            runHeadless(backend, 3, startOne);
+            fake::resetCallCounts();
+            runHeadless(backend, 3, profileStop);
+            report("headless_profile");
+            runHeadless(backend, 3, profileStart);
+        }
+
+        /* What the overlay does while open: list the roots, and rescan from the last scan once a title changed. */
+        ScanArena arena;
+        ModuleTable table;
+        ScanState state;
+        scanModules(&fs, arena, table, state, nullptr);
+        fake::resetCallCounts();
+        TitleListing listing;
+        listTitles(&fs, listing);
+        report("rescan_check");
+
+        if (!programIds.empty()) {
+            char path[FS_MAX_PATH];
+            std::snprintf(path, FS_MAX_PATH, "/atmosphere/contents/%016lX/toolbox.json", programIds.front());
+            fake::writeFile(path, toolboxes.front());
+            fake::resetCallCounts();
+            ScanArena rescanArena;
+            ModuleTable rescanTable;
+            scanModules(&fs, rescanArena, rescanTable, state, nullptr);
+            report("rescan_one_changed");
+        }
+    }
+
+    nlohmann::json memory = nlohmann::json::array();
+    if (enabled("list_memory")) {
+        auto report = [&](const char *name, const bench::AllocStats &used) {
+            memory.push_back({ {"name", name}, {"modules", config.listModules}, {"allocations", used.allocations}, {"bytes", used.bytes} });
+        };
+        report("list_rows_eager", measureEagerRows(config.listModules));
+        report("list_rows_virtual", measureVirtualRows(config.listModules));
+    }
+
+    if (enabled("scan_memory")) {
+        /* Heap traffic of one scan and what its result keeps alive, measured while the result still exists. */
+        auto report = [&](const char *name, size_t found, const bench::AllocStats &used) {
+            memory.push_back({ {"name", name}, {"modules", found}, {"allocations", used.total}, {"peak_bytes", used.peakBytes}, {"retained_bytes", used.bytes} });
+        };
+        {
+            /* The fake keeps a snapshot of every open directory, which real fs sessions don't. */
+            bench::resetPeak();
+            bench::AllocStats start = bench::allocStats();
+            FsDir dir;
+            u32 count = 0;
+            if (R_SUCCEEDED(fsFsOpenDirectory(&fs, "/atmosphere/contents", FsDirOpenMode_ReadDirs, &dir))) {
+                for (const auto &entry : FsDirIterator(dir))
+                    count += entry.name[0] != '\0';
+                fsDirClose(&dir);
+            }
+            report("scan_heap_fake_dir", count, bench::allocDelta(start));
+        }
+        {
+            bench::resetPeak();
+            bench::AllocStats start = bench::allocStats();
+            std::list<legacy::ToolboxInfo> modules;
+            legacy::scanModules(&fs, modules);
+            report("scan_heap_legacy", modules.size(), bench::allocDelta(start));
+        }
+        {
+            bench::resetPeak();
+            bench::AllocStats start = bench::allocStats();
+            ScanArena arena;
+            ModuleTable table;
+            scanModules(&fs, arena, table, nullptr);
+            report("scan_heap_arena", table.size(), bench::allocDelta(start));
+        }
+    }
+
+    fsFsClose(&fs);
+
+    /* Whole process, including the corpus and the fake filesystem. */
+    HeapStats heap;
+    getHeapStats(heap);
+    nlohmann::json histogram = nlohmann::json::array();
+    for (u32 i = 0; i < HeapStats::Buckets; i++)
+        histogram.push_back({ {"min_bytes", HeapStats::bucketFloor(i)}, {"count", heap.histogram[i]} });
+
+    /* Every service call of the run through the overlay's ipcCall() wrappers, the corpus setup doesn't go through them. */
+    nlohmann::json ipc = nlohmann::json::array();
+    for (u32 call = 0; call < u32(IpcCall::Count); call++) {
+        IpcCallStats stats;
+        getIpcStats(IpcCall(call), stats);
+        if (stats.calls == 0)
+            continue;
+        nlohmann::json latency = nlohmann::json::array();
+        for (u32 i = 0; i < IpcCallStats::Buckets; i++)
+            latency.push_back({ {"min_us", IpcCallStats::bucketFloorUs(i)}, {"count", stats.histogram[i]} });
+        ipc.push_back({
+            {"call", ipcCallName(IpcCall(call))},
+            {"calls", stats.calls},
+            {"failures", stats.failures},
+            {"total_ns", stats.totalNs},
+            {"mean_ns", stats.totalNs / stats.calls},
+            {"max_ns", stats.maxNs},
+            {"histogram", latency},
+        });
+    }
+
+    nlohmann::json output = {
+        {"config", {
+            {"seed", config.corpus.seed},
+            {"modules", titles},
+            {"listed", programIds.size()},
+            {"toolbox_min_size", config.corpus.toolboxMinSize},
+            {"toolbox_max_size", config.corpus.toolboxMaxSize},
+            {"malformed_percent", config.corpus.malformedPercent},
+            {"junk_directories", config.corpus.junkDirectories},
+            {"sxos_percent", config.corpus.sxosPercent},
+            {"copy_size", copySize},
+            {"iterations", config.iterations},
+            {"list_modules", config.listModules},
+            {"table_modules", config.tableModules},
+            {"latency_ns", config.latency.latencyNs},
+            {"jitter_ns", config.latency.jitterNs},
+            {"faults", config.faults.size()},
+            {"scan_latency_ns", config.scanLatencyNs},
+        }},
+        {"results", nlohmann::json::array()},
+        {"io", io},
+        {"parallel", parallel},
+        {"memory", memory},
+        {"ipc", ipc},
+        {"heap", {
+            {"current_bytes", heap.currentBytes},
+            {"peak_bytes", heap.peakBytes},
+            {"allocations", heap.allocations},
+            {"frees", heap.frees},
+            {"histogram", histogram},
+        }},
+    };
+    for (const auto &result : results)
+        output["results"].push_back(bench::toJson(result));
+
+    std::puts(output.dump(2).c_str());
+
+    /* Injected faults make anything fail, without them only the parsers of the malformed files may. */
+    u32 failed = 0;
+    if (config.faults.empty()) {
+        for (const auto &result : results) {
+            if (result.errors == 0 || std::find(std::begin(MalformedCorpusBenches), std::end(MalformedCorpusBenches), std::string_view(result.name)) != std::end(MalformedCorpusBenches))
+                continue;
+            std::fprintf(stderr, "%s: %lu errors\n", result.name.c_str(), result.errors);
+            failed++;
+        }
+    }
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
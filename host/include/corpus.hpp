@@ -0,0 +1,86 @@
+#pragma once
+
+#include <switch.h>
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/* Reproducible synthetic SD card layouts for benchmarks and regression runs. */
+namespace corpus {
+
+    enum class ToolboxKind : u8 {
+        None,
+        Valid,
+        Truncated,
+        MissingField,
+        WrongType,
+        BadProgramId,
+        Empty,
+    };
+
+    enum class ExefsKind : u8 {
+        None,
+        Npdm,
+        Nsp,
+    };
+
+    struct Config {
+        u64 seed = 1;
+        u32 titles = 64;
+        u32 toolboxMinSize = 128;
+        u32 toolboxMaxSize = 512;
+        /* Ratios are in percent of the generated titles. */
+        u32 toolboxPercent = 90;
+        u32 malformedPercent = 5;
+        u32 rebootPercent = 30;
+        u32 boot2Percent = 25;
+        u32 exefsPercent = 50;
+        u32 runningPercent = 50;
+        /* Titles that also get a copy under /sxos/titles. */
+        u32 sxosPercent = 0;
+        /* Directories under the contents root that aren't title ids at all. */
+        u32 junkDirectories = 2;
+        std::vector<std::pair<std::string, u32>> bootPayloads = {
+            { "/bootloader/boot-sxos.dat", 4 * 1024 * 1024 },
+            { "/boot.dat", 4 * 1024 * 1024 },
+        };
+    };
+
+    struct Title {
+        u64 programId;
+        std::string name;
+        ToolboxKind toolbox;
+        ExefsKind exefs;
+        bool needReboot;
+        bool hasFlag;
+        bool running;
+        bool mirrored;
+        /* Used memory of the process while it runs, between 512 KiB and 8.5 MiB. */
+        u64 memoryUsage;
+    };
+
+    struct Manifest {
+        std::vector<Title> titles;
+        std::vector<std::string> junkDirectories;
+
+        /* Titles the overlay is expected to list, through their toolbox or their exefs, in directory order. */
+        std::vector<const Title *> listed() const;
+    };
+
+    using DirectorySink = std::function<void(std::string_view path)>;
+    using FileSink = std::function<void(std::string_view path, std::string_view data)>;
+
+    Manifest generate(const Config &config, const DirectorySink &makeDirectory, const FileSink &writeFile);
+
+    /* Resets the fake SD card and process table and fills them with a generated corpus. */
+    Manifest generateFake(const Config &config);
+
+    /* Writes a generated corpus below root on the host filesystem. */
+    Manifest generateDirectory(const Config &config, const std::string &root);
+
+    std::string makeNpdm(std::string_view name);
+    std::string makeNsp(std::string_view npdm);
+
+}
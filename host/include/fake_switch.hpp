@@ -0,0 +1,69 @@
+#pragma once
+
+#include <switch.h>
+
+#include <string>
+#include <string_view>
+
+/* Setup and inspection of the in-memory SD card and process table behind the host switch.h. */
+namespace fake {
+
+    void reset();
+
+    void makeDirectory(std::string_view path);
+    void writeFile(std::string_view path, std::string_view data);
+    bool exists(std::string_view path);
+    bool readFile(std::string_view path, std::string &data);
+    /* What fsFsGetFileTimeStampRaw reports for the file, instead of the counter writes advance. */
+    bool setModified(std::string_view path, u64 modified);
+
+    void setRunning(u64 programId, bool running);
+    bool isRunning(u64 programId);
+    /* What svcGetInfo reports as the used memory of the program's process while it runs. */
+    void setMemoryUsage(u64 programId, u64 bytes);
+    /* The system pool reports baseUsage plus the usage of every running program as used. */
+    void setSystemPool(u64 size, u64 baseUsage);
+
+    enum class Call : u8 {
+        OpenDirectory,
+        ReadDirectory,
+        OpenFile,
+        ReadFile,
+        WriteFile,
+        GetFileSize,
+        CreateFile,
+        DeleteFile,
+        CreateDirectory,
+        GetTimeStamp,
+        GetProcessId,
+        GetProcessInfo,
+        GetInfo,
+        GetSystemInfo,
+        LaunchProgram,
+        TerminateProgram,
+        Count,
+    };
+
+    /* Latency and failures injected into every call of one kind, before it reaches the fake. */
+    struct Fault {
+        u64 latencyNs = 0;
+        u64 jitterNs = 0;
+        u32 errorPercent = 0;
+        Result error = 0;
+        /* Only calls whose path contains this are affected, empty matches all of them. */
+        std::string pathFilter;
+    };
+
+    void setFault(Call call, const Fault &fault);
+    void clearFaults();
+    void setFaultSeed(u64 seed);
+
+    /* Number of calls of one kind since the last reset, failed and injected ones included. */
+    u64 callCount(Call call);
+    void resetCallCounts();
+
+    /* Maps names like "open_file" or "get_pid" to their call, returns Call::Count for unknown names. */
+    Call parseCall(std::string_view name);
+    std::string_view callName(Call call);
+
+}
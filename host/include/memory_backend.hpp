@@ -0,0 +1,82 @@
+#pragma once
+
+#include "backend.hpp"
+
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+/*
+ * Backend that keeps files and processes in plain containers, without the
+ * fake libnx. Modules are added directly instead of being found on an SD
+ * card, so the engine can be driven without generating a corpus.
+ */
+class MemoryBackend final : public Backend {
+  public:
+    struct Module {
+        u64 programId;
+        std::string name;
+        u8 root;
+        bool needReboot;
+        /* What the process uses while it runs. */
+        u64 memoryUsage;
+        /* Listed in the table like a toolbox.json would, and checked on launch. */
+        std::vector<u64> dependencies = {};
+        /* A module that crashes after starting exits this long after each launch, 0 for one that keeps running. */
+        u64 exitAfterNs = 0;
+    };
+
+  private:
+    std::vector<Module> m_modules;
+    std::map<std::string, std::string, std::less<>> m_files;
+    std::set<u64> m_running;
+    /* When modules launched with exitAfterNs stop running, in ticks. */
+    std::map<u64, u64> m_exits;
+    /* The engine launches and terminates from several threads at once. */
+    mutable std::mutex m_processMutex;
+    u64 m_launchLatencyNs = 0;
+    u32 m_orderViolations = 0;
+    u64 m_poolSize = 0x1D800000;
+    u64 m_poolBaseUsage = 0x10000000;
+    u64 m_exosphereVersion = u64(1) << 56;
+
+    const Module *find(u64 programId) const;
+    /* Lets modules whose time ran out exit, with m_processMutex held. */
+    void reapExited();
+
+  public:
+    /* Replaces a module with the same program id and root. */
+    void addModule(const Module &module);
+    void removeModule(u64 programId);
+    void writeFile(std::string_view path, std::string_view data = {});
+    void setRunning(u64 programId, bool running);
+    void setSystemPool(u64 size, u64 baseUsage);
+    void setExosphereVersion(u64 version) { this->m_exosphereVersion = version; }
+    /* How long a launch or termination takes, spent outside the lock. */
+    void setLaunchLatency(u64 ns) { this->m_launchLatencyNs = ns; }
+    /* Launches of a module while one of its dependencies wasn't running. */
+    u32 orderViolations() const;
+
+    Result scan(ScanArena &arena, ModuleTable &table, ScanState &state, u32 roots) override;
+    Result listTitles(TitleListing &listing, u32 roots) override;
+    Result scanTitles(const u64 *programIds, u32 count, ScanArena &arena, ModuleTable &table, u32 roots) override;
+
+    bool fileExists(const char *path) override;
+    Result readFile(const char *path, ScanArena &arena, std::string_view &data) override;
+    Result createFile(const char *path) override;
+    Result deleteFile(const char *path) override;
+    Result createDirectory(const char *path) override;
+    Result copyFile(const char *srcPath, const char *destPath) override;
+    Result appendFile(const char *path, std::string_view data, s64 maxSize) override;
+
+    bool isRunning(u64 programId) override;
+    Result launchProgram(u64 programId) override;
+    Result terminateProgram(u64 programId) override;
+    Result getMemoryUsage(u64 programId, u64 &usedBytes) override;
+    Result getSystemPoolUsage(u64 &size, u64 &usedBytes) override;
+
+    Result getExosphereVersion(u64 &version) override;
+    Result shutdown(bool reboot) override;
+};
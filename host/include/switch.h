@@ -0,0 +1,212 @@
+#pragma once
+
+/*
+ * Minimal stand-in for the parts of libnx the shared sources use, so they can be
+ * built and benchmarked on a Linux host. Everything is backed by the in-memory
+ * filesystem and process table in fake_switch.cpp, see fake_switch.hpp.
+ */
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef uint64_t u64;
+typedef int8_t s8;
+typedef int16_t s16;
+typedef int32_t s32;
+typedef int64_t s64;
+
+typedef u32 Result;
+typedef u32 Handle;
+
+#define INVALID_HANDLE ((Handle)0)
+
+#define R_SUCCEEDED(res) ((res) == 0)
+#define R_FAILED(res) ((res) != 0)
+#define R_MODULE(res) ((res) & 0x1FF)
+#define R_DESCRIPTION(res) (((res) >> 9) & 0x1FFF)
+#define MAKERESULT(module, description) \
+    ((((module) & 0x1FF)) | ((description) & 0x1FFF) << 9)
+
+enum {
+    Module_Kernel = 1,
+    Module_Fs = 2,
+    Module_Pm = 15,
+    Module_Libnx = 345,
+};
+
+enum {
+    LibnxError_OutOfMemory = 2,
+    LibnxError_NotFound = 9,
+    LibnxError_IoError = 10,
+    LibnxError_BadInput = 11,
+    LibnxError_IncompatSysVer = 37,
+};
+
+#define FS_MAX_PATH 0x301
+
+typedef struct {
+    u32 id;
+} FsFileSystem;
+
+typedef struct {
+    u32 id;
+} FsFile;
+
+typedef struct {
+    u32 id;
+} FsDir;
+
+typedef enum {
+    FsDirEntryType_Dir = 0,
+    FsDirEntryType_File = 1,
+} FsDirEntryType;
+
+typedef struct {
+    char name[FS_MAX_PATH];
+    u8 pad[3];
+    s8 type;
+    u8 pad2[3];
+    s64 file_size;
+} FsDirectoryEntry;
+
+typedef struct {
+    u64 created;
+    u64 modified;
+    u64 accessed;
+    u8 is_valid;
+    u8 padding[7];
+} FsTimeStampRaw;
+
+typedef enum {
+    FsOpenMode_Read = 1 << 0,
+    FsOpenMode_Write = 1 << 1,
+    FsOpenMode_Append = 1 << 2,
+} FsOpenMode;
+
+typedef enum {
+    FsDirOpenMode_ReadDirs = 1 << 0,
+    FsDirOpenMode_ReadFiles = 1 << 1,
+} FsDirOpenMode;
+
+typedef enum {
+    FsCreateOption_BigFile = 1 << 0,
+} FsCreateOption;
+
+typedef enum {
+    FsReadOption_None = 0,
+} FsReadOption;
+
+typedef enum {
+    FsWriteOption_None = 0,
+    FsWriteOption_Flush = 1 << 0,
+} FsWriteOption;
+
+Result fsOpenSdCardFileSystem(FsFileSystem *out);
+void fsFsClose(FsFileSystem *fs);
+Result fsFsOpenDirectory(FsFileSystem *fs, const char *path, u32 mode, FsDir *out);
+Result fsFsOpenFile(FsFileSystem *fs, const char *path, u32 mode, FsFile *out);
+Result fsFsCreateFile(FsFileSystem *fs, const char *path, s64 size, u32 option);
+Result fsFsDeleteFile(FsFileSystem *fs, const char *path);
+Result fsFsCreateDirectory(FsFileSystem *fs, const char *path);
+Result fsFsGetFileTimeStampRaw(FsFileSystem *fs, const char *path, FsTimeStampRaw *out);
+
+Result fsDirRead(FsDir *d, s64 *total_entries, size_t max_entries, FsDirectoryEntry *buf);
+void fsDirClose(FsDir *d);
+
+Result fsFileRead(FsFile *f, s64 off, void *buf, u64 read_size, u32 option, u64 *bytes_read);
+Result fsFileWrite(FsFile *f, s64 off, const void *buf, u64 write_size, u32 option);
+Result fsFileGetSize(FsFile *f, s64 *out);
+void fsFileClose(FsFile *f);
+
+typedef enum {
+    NcmStorageId_None = 0,
+} NcmStorageId;
+
+typedef struct {
+    u64 program_id;
+    u8 storageID;
+    u8 pad[7];
+} NcmProgramLocation;
+
+typedef struct {
+    u64 keys_held;
+    u64 flags;
+} CfgOverrideStatus;
+
+typedef enum {
+    InfoType_TotalMemorySize = 6,
+    InfoType_UsedMemorySize = 7,
+} InfoType;
+
+typedef enum {
+    SystemInfoType_TotalPhysicalMemorySize = 0,
+    SystemInfoType_UsedPhysicalMemorySize = 1,
+} SystemInfoType;
+
+typedef enum {
+    PhysicalMemorySystemInfo_Application = 0,
+    PhysicalMemorySystemInfo_Applet = 1,
+    PhysicalMemorySystemInfo_System = 2,
+    PhysicalMemorySystemInfo_SystemUnsafe = 3,
+} PhysicalMemorySystemInfo;
+
+Result pmdmntGetProcessId(u64 *pid_out, u64 program_id);
+Result pmdmntAtmosphereGetProcessInfo(Handle *handle_out, NcmProgramLocation *loc_out, CfgOverrideStatus *status_out, u64 pid);
+Result pmshellLaunchProgram(u32 launch_flags, const NcmProgramLocation *location, u64 *pid);
+Result pmshellTerminateProgram(u64 program_id);
+
+/* The services below only report success, the fake has no CFW or power state to change. */
+typedef enum {
+    NifmServiceType_Admin = 2,
+} NifmServiceType;
+
+typedef enum {
+    SplConfigItem_ExosphereApiVersion = 65000,
+} SplConfigItem;
+
+Result smInitialize(void);
+Result nifmInitialize(NifmServiceType service_type);
+Result splInitialize(void);
+void splExit(void);
+/* Reports Atmosphère 1.0.0 for the Exosphère API version. */
+Result splGetConfig(SplConfigItem config_item, u64 *out_config);
+Result spsmInitialize(void);
+void spsmExit(void);
+Result spsmShutdown(bool reboot);
+
+typedef void (*ThreadFunc)(void *);
+
+/* Backed by a std::thread, stack_mem, stack_sz, prio and cpuid are ignored. */
+typedef struct {
+    void *handle;
+} Thread;
+
+Result threadCreate(Thread *t, ThreadFunc entry, void *arg, void *stack_mem, size_t stack_sz, int prio, int cpuid);
+Result threadStart(Thread *t);
+Result threadWaitForExit(Thread *t);
+Result threadClose(Thread *t);
+
+/* Backed by the standard ones, which need no setup, so the init functions do nothing. */
+typedef std::mutex Mutex;
+typedef std::condition_variable_any CondVar;
+
+void mutexInit(Mutex *m);
+void mutexLock(Mutex *m);
+void mutexUnlock(Mutex *m);
+void condvarInit(CondVar *c);
+Result condvarWait(CondVar *c, Mutex *m);
+Result condvarWakeAll(CondVar *c);
+
+void svcSleepThread(s64 nano);
+Result svcGetInfo(u64 *out, u32 id0, Handle handle, u64 id1);
+Result svcCloseHandle(Handle handle);
+Result svcGetSystemInfo(u64 *out, u64 id0, Handle handle, u64 id1);
+u64 armGetSystemTick(void);
+u64 armGetSystemTickFreq(void);
+u64 armTicksToNs(u64 tick);
+u64 armNsToTicks(u64 ns);
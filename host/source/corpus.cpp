@@ -0,0 +1,262 @@
+#include "corpus.hpp"
+
+#include "fake_switch.hpp"
+#include "sysmodule.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <set>
+
+namespace corpus {
+
+    namespace {
+
+        /* splitmix64, so a seed produces the same corpus regardless of the standard library. */
+        class Random {
+          private:
+            u64 m_state;
+
+          public:
+            explicit Random(u64 seed) : m_state(seed) {}
+
+            u64 next() {
+                u64 z = (this->m_state += 0x9E3779B97F4A7C15ULL);
+                z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+                z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+                return z ^ (z >> 31);
+            }
+
+            u32 range(u32 min, u32 max) {
+                return max <= min ? min : min + this->next() % (max - min + 1);
+            }
+
+            bool chance(u32 percent) {
+                return this->next() % 100 < percent;
+            }
+        };
+
+        constexpr u64 ProgramIdPrefixes[] = {
+            0x0100000000000000ULL,
+            0x010000000000B000ULL,
+            0x4200000000000000ULL,
+        };
+
+        constexpr ToolboxKind MalformedKinds[] = {
+            ToolboxKind::Truncated,
+            ToolboxKind::MissingField,
+            ToolboxKind::WrongType,
+            ToolboxKind::BadProgramId,
+            ToolboxKind::Empty,
+        };
+
+        std::string makeToolbox(const Title &title, u32 size) {
+            char tid[17];
+            std::snprintf(tid, sizeof(tid), "%016lX", title.programId);
+            const char *reboot = title.needReboot ? "true" : "false";
+
+            std::string data;
+            switch (title.toolbox) {
+                case ToolboxKind::Empty:
+                    return data;
+                case ToolboxKind::MissingField:
+                    data = "{\"name\":\"" + title.name + "\",\"tid\":\"" + tid + "\"";
+                    break;
+                case ToolboxKind::WrongType:
+                    data = "{\"name\":\"" + title.name + "\",\"tid\":" + std::to_string(title.programId) + ",\"requires_reboot\":" + reboot;
+                    break;
+                case ToolboxKind::BadProgramId:
+                    data = "{\"name\":\"" + title.name + "\",\"tid\":\"01000Z00000G00\",\"requires_reboot\":" + reboot;
+                    break;
+                default:
+                    data = "{\"name\":\"" + title.name + "\",\"tid\":\"" + tid + "\",\"requires_reboot\":" + reboot;
+                    break;
+            }
+
+            /* Pad with a dummy field so the file reaches the requested size. */
+            data += ",\"pad\":\"";
+            if (data.size() + 2 < size)
+                data.append(size - data.size() - 2, 'x');
+            data += "\"}";
+
+            if (title.toolbox == ToolboxKind::Truncated)
+                data.resize(data.size() / 2);
+            return data;
+        }
+
+        template <typename T>
+        void append(std::string &data, T value) {
+            data.append(reinterpret_cast<const char *>(&value), sizeof(value));
+        }
+
+    }
+
+    std::vector<const Title *> Manifest::listed() const {
+        std::vector<const Title *> titles;
+        for (const auto &title : this->titles) {
+            if ((title.toolbox == ToolboxKind::Valid || title.exefs != ExefsKind::None) && title.programId != TeslaProgramId)
+                titles.push_back(&title);
+        }
+        return titles;
+    }
+
+    std::string makeNpdm(std::string_view name) {
+        /* Only the META header is generated, which is all the overlay ever looks at. */
+        std::string data(0x80, '\0');
+        std::memcpy(data.data(), "META", 4);
+        std::memcpy(data.data() + 0x20, name.data(), std::min<size_t>(name.size(), 0x10));
+        return data;
+    }
+
+    std::string makeNsp(std::string_view npdm) {
+        constexpr std::string_view names[] = { "main", "main.npdm" };
+        const std::string main(0x100, '\xCC');
+        const std::string_view contents[] = { main, npdm };
+
+        std::string stringTable;
+        for (auto name : names) {
+            stringTable += name;
+            stringTable += '\0';
+        }
+        stringTable.resize((stringTable.size() + 0x1F) & ~0x1F, '\0');
+
+        std::string data("PFS0");
+        append<u32>(data, 2);
+        append<u32>(data, stringTable.size());
+        append<u32>(data, 0);
+
+        u64 offset = 0;
+        u32 nameOffset = 0;
+        for (u32 i = 0; i < 2; i++) {
+            append<u64>(data, offset);
+            append<u64>(data, contents[i].size());
+            append<u32>(data, nameOffset);
+            append<u32>(data, 0);
+            offset += contents[i].size();
+            nameOffset += names[i].size() + 1;
+        }
+
+        data += stringTable;
+        for (auto content : contents)
+            data += content;
+        return data;
+    }
+
+    Manifest generate(const Config &config, const DirectorySink &makeDirectory, const FileSink &writeFile) {
+        Random random(config.seed);
+        Manifest manifest;
+
+        std::set<u64> programIds;
+        if (config.titles > 0)
+            programIds.insert(TeslaProgramId);
+        while (programIds.size() < config.titles)
+            programIds.insert(ProgramIdPrefixes[random.range(0, std::size(ProgramIdPrefixes) - 1)] | random.range(0, 0xFFFF));
+
+        for (u64 programId : programIds) {
+            Title &title = manifest.titles.emplace_back();
+            title.programId = programId;
+            title.name = "Module " + std::to_string(manifest.titles.size());
+            title.toolbox = ToolboxKind::None;
+            title.exefs = ExefsKind::None;
+
+            if (random.chance(config.toolboxPercent)) {
+                title.toolbox = ToolboxKind::Valid;
+                if (random.chance(config.malformedPercent))
+                    title.toolbox = MalformedKinds[random.range(0, std::size(MalformedKinds) - 1)];
+            }
+            if (programId == TeslaProgramId)
+                title.toolbox = ToolboxKind::Valid;
+            if (random.chance(config.exefsPercent))
+                title.exefs = random.chance(50) ? ExefsKind::Npdm : ExefsKind::Nsp;
+
+            title.needReboot = random.chance(config.rebootPercent);
+            title.hasFlag = random.chance(config.boot2Percent);
+            title.running = random.chance(config.runningPercent);
+            /* Derived from the id instead of drawn, so existing corpora stay the same for a given seed. */
+            title.memoryUsage = 0x80000 + (((programId * 0x9E3779B97F4A7C15ULL) >> 41) & ~u64(0xFFF));
+        }
+
+        makeDirectory("/atmosphere/contents");
+        if (config.sxosPercent > 0)
+            makeDirectory("/sxos/titles");
+
+        char path[FS_MAX_PATH];
+        for (auto &title : manifest.titles) {
+            std::string toolbox;
+            if (title.toolbox != ToolboxKind::None)
+                toolbox = makeToolbox(title, random.range(config.toolboxMinSize, config.toolboxMaxSize));
+            std::string npdmName = "mod" + std::to_string(title.programId & 0xFFFF);
+
+            /* Only drawn when asked for, so corpora without SX OS copies stay the same for a given seed. */
+            title.mirrored = config.sxosPercent > 0 && random.chance(config.sxosPercent);
+
+            for (const char *root : { "/atmosphere/contents", "/sxos/titles" }) {
+                if (root != std::string_view("/atmosphere/contents") && !title.mirrored)
+                    break;
+
+                std::snprintf(path, FS_MAX_PATH, "%s/%016lX", root, title.programId);
+                makeDirectory(path);
+
+                if (title.toolbox != ToolboxKind::None) {
+                    std::snprintf(path, FS_MAX_PATH, "%s/%016lX/toolbox.json", root, title.programId);
+                    writeFile(path, toolbox);
+                }
+                if (title.hasFlag) {
+                    std::snprintf(path, FS_MAX_PATH, "%s/%016lX/flags/boot2.flag", root, title.programId);
+                    writeFile(path, "");
+                }
+
+                if (title.exefs == ExefsKind::Npdm) {
+                    std::snprintf(path, FS_MAX_PATH, "%s/%016lX/exefs/main.npdm", root, title.programId);
+                    writeFile(path, makeNpdm(npdmName));
+                } else if (title.exefs == ExefsKind::Nsp) {
+                    std::snprintf(path, FS_MAX_PATH, "%s/%016lX/exefs.nsp", root, title.programId);
+                    writeFile(path, makeNsp(makeNpdm(npdmName)));
+                }
+            }
+        }
+
+        for (u32 i = 0; i < config.junkDirectories; i++) {
+            std::string &name = manifest.junkDirectories.emplace_back("junk_" + std::to_string(i));
+            makeDirectory("/atmosphere/contents/" + name);
+        }
+
+        for (const auto &[payloadPath, size] : config.bootPayloads) {
+            std::string payload(size, '\0');
+            for (u32 i = 0; i < size; i++)
+                payload[i] = char(i * 31 + 7);
+            writeFile(payloadPath, payload);
+        }
+
+        return manifest;
+    }
+
+    Manifest generateFake(const Config &config) {
+        fake::reset();
+        Manifest manifest = generate(config, fake::makeDirectory, fake::writeFile);
+        for (const auto &title : manifest.titles) {
+            fake::setRunning(title.programId, title.running);
+            fake::setMemoryUsage(title.programId, title.memoryUsage);
+        }
+        return manifest;
+    }
+
+    Manifest generateDirectory(const Config &config, const std::string &root) {
+        auto makeDirectory = [&](std::string_view path) {
+            std::error_code ec;
+            std::filesystem::create_directories(root + std::string(path), ec);
+        };
+        auto writeFile = [&](std::string_view path, std::string_view data) {
+            std::filesystem::path fullPath = root + std::string(path);
+            std::error_code ec;
+            std::filesystem::create_directories(fullPath.parent_path(), ec);
+            if (FILE *file = std::fopen(fullPath.c_str(), "wb")) {
+                std::fwrite(data.data(), 1, data.size(), file);
+                std::fclose(file);
+            }
+        };
+        return generate(config, makeDirectory, writeFile);
+    }
+
+}
@@ -0,0 +1,692 @@
+#include "fake_switch.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+    constexpr Result ResultPathNotFound = MAKERESULT(Module_Fs, 1);
+    constexpr Result ResultPathAlreadyExists = MAKERESULT(Module_Fs, 2);
+    constexpr Result ResultInvalidHandle = MAKERESULT(Module_Fs, 6001);
+    constexpr Result ResultFileExtensionWithoutOpenModeAllowAppend = MAKERESULT(Module_Fs, 6201);
+    constexpr Result ResultInvalidKernelHandle = MAKERESULT(Module_Kernel, 114);
+    constexpr Result ResultInvalidKernelEnumValue = MAKERESULT(Module_Kernel, 120);
+    constexpr Result ResultProcessNotFound = MAKERESULT(Module_Pm, 1);
+    constexpr Result ResultAlreadyStarted = MAKERESULT(Module_Pm, 2);
+
+    struct Node {
+        bool isDir;
+        std::string data;
+        /* Bumped on every change, stands in for the FAT modification time. */
+        u64 modified;
+        std::map<std::string, std::shared_ptr<Node>, std::less<>> children;
+    };
+
+    struct OpenFile {
+        std::shared_ptr<Node> node;
+        u32 mode;
+        std::string path;
+    };
+
+    struct OpenDir {
+        std::vector<FsDirectoryEntry> entries;
+        size_t next;
+    };
+
+    std::mutex g_mutex;
+    std::shared_ptr<Node> g_root = std::make_shared<Node>(Node{.isDir = true});
+    std::unordered_map<u32, OpenFile> g_files;
+    std::unordered_map<u32, OpenDir> g_dirs;
+    std::unordered_map<u64, u64> g_processes;
+    std::unordered_map<u64, u64> g_memoryUsage;
+    /* Process handles are the pid they were opened for. */
+    std::unordered_map<Handle, u64> g_processHandles;
+    u64 g_poolSize = 0x1D800000;
+    u64 g_poolBaseUsage = 0x10000000;
+    u32 g_nextHandle = 1;
+    u64 g_clock = 1;
+    u64 g_nextPid = 0x80;
+
+    std::mutex g_faultMutex;
+    std::array<fake::Fault, size_t(fake::Call::Count)> g_faults;
+    std::atomic<bool> g_faultsEnabled = false;
+    u64 g_faultState = 1;
+    std::array<std::atomic<u64>, size_t(fake::Call::Count)> g_callCounts;
+
+    struct FakeThread {
+        ThreadFunc entry;
+        void *arg;
+        std::thread thread;
+    };
+
+    constexpr std::string_view CallNames[] = {
+        "open_dir", "read_dir", "open_file", "read_file", "write_file", "get_size",
+        "create_file", "delete_file", "create_dir", "get_timestamp", "get_pid", "get_process_info", "get_info", "get_system_info", "launch", "terminate",
+    };
+    static_assert(std::size(CallNames) == size_t(fake::Call::Count));
+
+    u64 nextFaultRandom() {
+        u64 z = (g_faultState += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    /*
+     * Applies the configured fault for a call. The delay is slept outside of the
+     * filesystem lock so concurrent callers overlap like they would on hardware.
+     */
+    template <typename PathGetter>
+    Result injectWith(fake::Call call, PathGetter &&getPath) {
+        g_callCounts[size_t(call)].fetch_add(1, std::memory_order_relaxed);
+        if (!g_faultsEnabled.load(std::memory_order_relaxed))
+            return 0;
+
+        u64 delay;
+        bool fail;
+        Result error;
+        {
+            std::scoped_lock lock(g_faultMutex);
+            const fake::Fault &fault = g_faults[size_t(call)];
+            if (fault.latencyNs == 0 && fault.jitterNs == 0 && fault.errorPercent == 0)
+                return 0;
+            if (!fault.pathFilter.empty() && std::string(getPath()).find(fault.pathFilter) == std::string::npos)
+                return 0;
+
+            delay = fault.latencyNs + (fault.jitterNs > 0 ? nextFaultRandom() % (fault.jitterNs + 1) : 0);
+            fail = nextFaultRandom() % 100 < fault.errorPercent;
+            error = fault.error;
+        }
+
+        if (delay > 0)
+            std::this_thread::sleep_for(std::chrono::nanoseconds(delay));
+        return fail ? error : 0;
+    }
+
+    Result inject(fake::Call call, const char *path) {
+        return injectWith(call, [path] { return path; });
+    }
+
+    Result inject(fake::Call call) {
+        return injectWith(call, [] { return ""; });
+    }
+
+    Result inject(fake::Call call, const FsFile *f) {
+        return injectWith(call, [f] {
+            std::scoped_lock lock(g_mutex);
+            auto it = g_files.find(f->id);
+            return it != g_files.end() ? it->second.path : std::string();
+        });
+    }
+
+    /* Splits path into its parent directory node and the last component. */
+    Node *resolveParent(std::string_view path, std::string_view &name) {
+        Node *node = g_root.get();
+        size_t pos = 0;
+        while (true) {
+            while (pos < path.size() && path[pos] == '/')
+                pos++;
+            size_t end = path.find('/', pos);
+            if (end == std::string_view::npos) {
+                name = path.substr(pos);
+                return node;
+            }
+
+            /* Trailing separators refer to the directory itself. */
+            size_t next = end;
+            while (next < path.size() && path[next] == '/')
+                next++;
+            if (next == path.size()) {
+                name = path.substr(pos, end - pos);
+                return node;
+            }
+
+            auto it = node->children.find(path.substr(pos, end - pos));
+            if (it == node->children.end() || !it->second->isDir)
+                return nullptr;
+            node = it->second.get();
+            pos = end;
+        }
+    }
+
+    std::shared_ptr<Node> resolve(std::string_view path) {
+        std::string_view name;
+        Node *parent = resolveParent(path, name);
+        if (parent == nullptr)
+            return nullptr;
+        if (name.empty())
+            return parent == g_root.get() ? g_root : nullptr;
+
+        auto it = parent->children.find(name);
+        return it != parent->children.end() ? it->second : nullptr;
+    }
+
+    Node *makeDirectories(std::string_view path) {
+        Node *node = g_root.get();
+        size_t pos = 0;
+        while (pos < path.size()) {
+            size_t end = path.find('/', pos);
+            if (end == std::string_view::npos)
+                end = path.size();
+            if (end > pos) {
+                auto &child = node->children[std::string(path.substr(pos, end - pos))];
+                if (child == nullptr)
+                    child = std::make_shared<Node>(Node{.isDir = true});
+                node = child.get();
+            }
+            pos = end + 1;
+        }
+        return node;
+    }
+
+}
+
+namespace fake {
+
+    void reset() {
+        std::scoped_lock lock(g_mutex);
+        g_root = std::make_shared<Node>(Node{.isDir = true});
+        g_files.clear();
+        g_dirs.clear();
+        g_processes.clear();
+        g_memoryUsage.clear();
+        g_processHandles.clear();
+    }
+
+    void makeDirectory(std::string_view path) {
+        std::scoped_lock lock(g_mutex);
+        makeDirectories(path);
+    }
+
+    void writeFile(std::string_view path, std::string_view data) {
+        std::scoped_lock lock(g_mutex);
+        size_t slash = path.rfind('/');
+        Node *parent = makeDirectories(path.substr(0, slash == std::string_view::npos ? 0 : slash));
+        auto &child = parent->children[std::string(path.substr(slash + 1))];
+        child = std::make_shared<Node>(Node{.isDir = false, .data = std::string(data), .modified = g_clock++});
+    }
+
+    bool exists(std::string_view path) {
+        std::scoped_lock lock(g_mutex);
+        return resolve(path) != nullptr;
+    }
+
+    bool readFile(std::string_view path, std::string &data) {
+        std::scoped_lock lock(g_mutex);
+        auto node = resolve(path);
+        if (node == nullptr || node->isDir)
+            return false;
+        data = node->data;
+        return true;
+    }
+
+    bool setModified(std::string_view path, u64 modified) {
+        std::scoped_lock lock(g_mutex);
+        auto node = resolve(path);
+        if (node == nullptr || node->isDir)
+            return false;
+        node->modified = modified;
+        return true;
+    }
+
+    void setRunning(u64 programId, bool running) {
+        std::scoped_lock lock(g_mutex);
+        if (!running)
+            g_processes.erase(programId);
+        else if (!g_processes.contains(programId))
+            g_processes[programId] = g_nextPid++;
+    }
+
+    bool isRunning(u64 programId) {
+        std::scoped_lock lock(g_mutex);
+        return g_processes.contains(programId);
+    }
+
+    void setMemoryUsage(u64 programId, u64 bytes) {
+        std::scoped_lock lock(g_mutex);
+        g_memoryUsage[programId] = bytes;
+    }
+
+    void setSystemPool(u64 size, u64 baseUsage) {
+        std::scoped_lock lock(g_mutex);
+        g_poolSize = size;
+        g_poolBaseUsage = baseUsage;
+    }
+
+    void setFault(Call call, const Fault &fault) {
+        std::scoped_lock lock(g_faultMutex);
+        g_faults[size_t(call)] = fault;
+        g_faultsEnabled = true;
+    }
+
+    void clearFaults() {
+        std::scoped_lock lock(g_faultMutex);
+        g_faults = {};
+        g_faultsEnabled = false;
+    }
+
+    void setFaultSeed(u64 seed) {
+        std::scoped_lock lock(g_faultMutex);
+        g_faultState = seed;
+    }
+
+    u64 callCount(Call call) {
+        return g_callCounts[size_t(call)].load(std::memory_order_relaxed);
+    }
+
+    void resetCallCounts() {
+        for (auto &count : g_callCounts)
+            count.store(0, std::memory_order_relaxed);
+    }
+
+    std::string_view callName(Call call) {
+        return CallNames[size_t(call)];
+    }
+
+    Call parseCall(std::string_view name) {
+        for (size_t i = 0; i < std::size(CallNames); i++) {
+            if (CallNames[i] == name)
+                return Call(i);
+        }
+        return Call::Count;
+    }
+
+}
+
+Result fsOpenSdCardFileSystem(FsFileSystem *out) {
+    out->id = 1;
+    return 0;
+}
+
+void fsFsClose(FsFileSystem *fs) {
+    fs->id = 0;
+}
+
+Result fsFsOpenDirectory(FsFileSystem *fs, const char *path, u32 mode, FsDir *out) {
+    if (Result rc = inject(fake::Call::OpenDirectory, path); R_FAILED(rc))
+        return rc;
+
+    std::scoped_lock lock(g_mutex);
+    auto node = resolve(path);
+    if (node == nullptr || !node->isDir)
+        return ResultPathNotFound;
+
+    /* Sized up front so the snapshot doesn't skew the heap peaks the bench reports. */
+    OpenDir dir{.next = 0};
+    dir.entries.reserve(node->children.size());
+    for (const auto &[name, child] : node->children) {
+        if (child->isDir ? !(mode & FsDirOpenMode_ReadDirs) : !(mode & FsDirOpenMode_ReadFiles))
+            continue;
+
+        FsDirectoryEntry &entry = dir.entries.emplace_back();
+        std::memset(&entry, 0, sizeof(entry));
+        std::strncpy(entry.name, name.c_str(), FS_MAX_PATH - 1);
+        entry.type = child->isDir ? FsDirEntryType_Dir : FsDirEntryType_File;
+        entry.file_size = child->isDir ? 0 : child->data.size();
+    }
+
+    out->id = g_nextHandle++;
+    g_dirs.emplace(out->id, std::move(dir));
+    return 0;
+}
+
+Result fsFsOpenFile(FsFileSystem *fs, const char *path, u32 mode, FsFile *out) {
+    if (Result rc = inject(fake::Call::OpenFile, path); R_FAILED(rc))
+        return rc;
+
+    std::scoped_lock lock(g_mutex);
+    auto node = resolve(path);
+    if (node == nullptr || node->isDir)
+        return ResultPathNotFound;
+
+    out->id = g_nextHandle++;
+    g_files.emplace(out->id, OpenFile{.node = std::move(node), .mode = mode, .path = path});
+    return 0;
+}
+
+Result fsFsCreateFile(FsFileSystem *fs, const char *path, s64 size, u32 option) {
+    if (Result rc = inject(fake::Call::CreateFile, path); R_FAILED(rc))
+        return rc;
+
+    std::scoped_lock lock(g_mutex);
+    std::string_view name;
+    Node *parent = resolveParent(path, name);
+    if (parent == nullptr || name.empty())
+        return ResultPathNotFound;
+    if (parent->children.contains(name))
+        return ResultPathAlreadyExists;
+
+    parent->children.emplace(std::string(name), std::make_shared<Node>(Node{.isDir = false, .data = std::string(size, '\0'), .modified = g_clock++}));
+    return 0;
+}
+
+Result fsFsDeleteFile(FsFileSystem *fs, const char *path) {
+    if (Result rc = inject(fake::Call::DeleteFile, path); R_FAILED(rc))
+        return rc;
+
+    std::scoped_lock lock(g_mutex);
+    std::string_view name;
+    Node *parent = resolveParent(path, name);
+    if (parent == nullptr)
+        return ResultPathNotFound;
+
+    auto it = parent->children.find(name);
+    if (it == parent->children.end() || it->second->isDir)
+        return ResultPathNotFound;
+
+    parent->children.erase(it);
+    return 0;
+}
+
+Result fsFsCreateDirectory(FsFileSystem *fs, const char *path) {
+    if (Result rc = inject(fake::Call::CreateDirectory, path); R_FAILED(rc))
+        return rc;
+
+    std::scoped_lock lock(g_mutex);
+    std::string_view name;
+    Node *parent = resolveParent(path, name);
+    if (parent == nullptr || name.empty())
+        return ResultPathNotFound;
+    if (parent->children.contains(name))
+        return ResultPathAlreadyExists;
+
+    parent->children.emplace(std::string(name), std::make_shared<Node>(Node{.isDir = true}));
+    return 0;
+}
+
+Result fsFsGetFileTimeStampRaw(FsFileSystem *fs, const char *path, FsTimeStampRaw *out) {
+    if (Result rc = inject(fake::Call::GetTimeStamp, path); R_FAILED(rc))
+        return rc;
+
+    std::scoped_lock lock(g_mutex);
+    auto node = resolve(path);
+    if (node == nullptr || node->isDir)
+        return ResultPathNotFound;
+
+    *out = { .created = node->modified, .modified = node->modified, .accessed = node->modified, .is_valid = 1 };
+    return 0;
+}
+
+Result fsDirRead(FsDir *d, s64 *total_entries, size_t max_entries, FsDirectoryEntry *buf) {
+    if (Result rc = inject(fake::Call::ReadDirectory); R_FAILED(rc))
+        return rc;
+
+    std::scoped_lock lock(g_mutex);
+    auto it = g_dirs.find(d->id);
+    if (it == g_dirs.end())
+        return ResultInvalidHandle;
+
+    OpenDir &dir = it->second;
+    size_t count = std::min(max_entries, dir.entries.size() - dir.next);
+    std::memcpy(buf, dir.entries.data() + dir.next, count * sizeof(FsDirectoryEntry));
+    dir.next += count;
+    *total_entries = count;
+    return 0;
+}
+
+void fsDirClose(FsDir *d) {
+    std::scoped_lock lock(g_mutex);
+    g_dirs.erase(d->id);
+}
+
+Result fsFileRead(FsFile *f, s64 off, void *buf, u64 read_size, u32 option, u64 *bytes_read) {
+    if (Result rc = inject(fake::Call::ReadFile, f); R_FAILED(rc))
+        return rc;
+
+    std::scoped_lock lock(g_mutex);
+    auto it = g_files.find(f->id);
+    if (it == g_files.end() || !(it->second.mode & FsOpenMode_Read))
+        return ResultInvalidHandle;
+
+    const std::string &data = it->second.node->data;
+    u64 count = off < s64(data.size()) ? std::min<u64>(read_size, data.size() - off) : 0;
+    std::memcpy(buf, data.data() + off, count);
+    *bytes_read = count;
+    return 0;
+}
+
+Result fsFileWrite(FsFile *f, s64 off, const void *buf, u64 write_size, u32 option) {
+    if (Result rc = inject(fake::Call::WriteFile, f); R_FAILED(rc))
+        return rc;
+
+    std::scoped_lock lock(g_mutex);
+    auto it = g_files.find(f->id);
+    if (it == g_files.end() || !(it->second.mode & FsOpenMode_Write))
+        return ResultInvalidHandle;
+
+    std::string &data = it->second.node->data;
+    if (off + write_size > data.size()) {
+        if (!(it->second.mode & FsOpenMode_Append))
+            return ResultFileExtensionWithoutOpenModeAllowAppend;
+        data.resize(off + write_size);
+    }
+    std::memcpy(data.data() + off, buf, write_size);
+    it->second.node->modified = g_clock++;
+    return 0;
+}
+
+Result fsFileGetSize(FsFile *f, s64 *out) {
+    if (Result rc = inject(fake::Call::GetFileSize, f); R_FAILED(rc))
+        return rc;
+
+    std::scoped_lock lock(g_mutex);
+    auto it = g_files.find(f->id);
+    if (it == g_files.end())
+        return ResultInvalidHandle;
+
+    *out = it->second.node->data.size();
+    return 0;
+}
+
+void fsFileClose(FsFile *f) {
+    std::scoped_lock lock(g_mutex);
+    g_files.erase(f->id);
+}
+
+Result pmdmntGetProcessId(u64 *pid_out, u64 program_id) {
+    if (Result rc = inject(fake::Call::GetProcessId); R_FAILED(rc))
+        return rc;
+
+    std::scoped_lock lock(g_mutex);
+    auto it = g_processes.find(program_id);
+    if (it == g_processes.end())
+        return ResultProcessNotFound;
+
+    *pid_out = it->second;
+    return 0;
+}
+
+Result pmdmntAtmosphereGetProcessInfo(Handle *handle_out, NcmProgramLocation *loc_out, CfgOverrideStatus *status_out, u64 pid) {
+    if (Result rc = inject(fake::Call::GetProcessInfo); R_FAILED(rc))
+        return rc;
+
+    std::scoped_lock lock(g_mutex);
+    for (const auto &[programId, processId] : g_processes) {
+        if (processId != pid)
+            continue;
+
+        *handle_out = g_nextHandle++;
+        g_processHandles.emplace(*handle_out, programId);
+        if (loc_out != nullptr)
+            *loc_out = { .program_id = programId, .storageID = NcmStorageId_None };
+        if (status_out != nullptr)
+            *status_out = {};
+        return 0;
+    }
+    return ResultProcessNotFound;
+}
+
+Result pmshellLaunchProgram(u32 launch_flags, const NcmProgramLocation *location, u64 *pid) {
+    if (Result rc = inject(fake::Call::LaunchProgram); R_FAILED(rc))
+        return rc;
+
+    std::scoped_lock lock(g_mutex);
+    if (g_processes.contains(location->program_id))
+        return ResultAlreadyStarted;
+
+    *pid = g_processes[location->program_id] = g_nextPid++;
+    return 0;
+}
+
+Result pmshellTerminateProgram(u64 program_id) {
+    if (Result rc = inject(fake::Call::TerminateProgram); R_FAILED(rc))
+        return rc;
+
+    std::scoped_lock lock(g_mutex);
+    return g_processes.erase(program_id) > 0 ? 0 : ResultProcessNotFound;
+}
+
+Result smInitialize(void) {
+    return 0;
+}
+
+Result nifmInitialize(NifmServiceType service_type) {
+    return 0;
+}
+
+Result splInitialize(void) {
+    return 0;
+}
+
+void splExit(void) {}
+
+Result splGetConfig(SplConfigItem config_item, u64 *out_config) {
+    if (config_item != SplConfigItem_ExosphereApiVersion)
+        return ResultInvalidKernelEnumValue;
+    *out_config = u64(1) << 56;
+    return 0;
+}
+
+Result spsmInitialize(void) {
+    return 0;
+}
+
+void spsmExit(void) {}
+
+Result spsmShutdown(bool reboot) {
+    return 0;
+}
+
+Result threadCreate(Thread *t, ThreadFunc entry, void *arg, void *stack_mem, size_t stack_sz, int prio, int cpuid) {
+    t->handle = new FakeThread{.entry = entry, .arg = arg};
+    return 0;
+}
+
+Result threadStart(Thread *t) {
+    auto *thread = static_cast<FakeThread *>(t->handle);
+    thread->thread = std::thread(thread->entry, thread->arg);
+    return 0;
+}
+
+Result threadWaitForExit(Thread *t) {
+    auto *thread = static_cast<FakeThread *>(t->handle);
+    if (thread->thread.joinable())
+        thread->thread.join();
+    return 0;
+}
+
+Result threadClose(Thread *t) {
+    auto *thread = static_cast<FakeThread *>(t->handle);
+    if (thread->thread.joinable())
+        thread->thread.detach();
+    delete thread;
+    t->handle = nullptr;
+    return 0;
+}
+
+void mutexInit(Mutex *m) {}
+
+void mutexLock(Mutex *m) {
+    m->lock();
+}
+
+void mutexUnlock(Mutex *m) {
+    m->unlock();
+}
+
+void condvarInit(CondVar *c) {}
+
+Result condvarWait(CondVar *c, Mutex *m) {
+    c->wait(*m);
+    return 0;
+}
+
+Result condvarWakeAll(CondVar *c) {
+    c->notify_all();
+    return 0;
+}
+
+Result svcGetInfo(u64 *out, u32 id0, Handle handle, u64 id1) {
+    if (Result rc = inject(fake::Call::GetInfo); R_FAILED(rc))
+        return rc;
+
+    std::scoped_lock lock(g_mutex);
+    auto it = g_processHandles.find(handle);
+    if (it == g_processHandles.end())
+        return ResultInvalidKernelHandle;
+    if (id0 != InfoType_UsedMemorySize && id0 != InfoType_TotalMemorySize)
+        return ResultInvalidKernelEnumValue;
+
+    auto usage = g_memoryUsage.find(it->second);
+    *out = usage != g_memoryUsage.end() ? usage->second : 0;
+    return 0;
+}
+
+Result svcCloseHandle(Handle handle) {
+    std::scoped_lock lock(g_mutex);
+    return g_processHandles.erase(handle) > 0 ? 0 : ResultInvalidKernelHandle;
+}
+
+Result svcGetSystemInfo(u64 *out, u64 id0, Handle handle, u64 id1) {
+    if (Result rc = inject(fake::Call::GetSystemInfo); R_FAILED(rc))
+        return rc;
+
+    if (handle != INVALID_HANDLE || id1 != PhysicalMemorySystemInfo_System)
+        return ResultInvalidKernelEnumValue;
+
+    std::scoped_lock lock(g_mutex);
+    if (id0 == SystemInfoType_TotalPhysicalMemorySize) {
+        *out = g_poolSize;
+        return 0;
+    }
+    if (id0 != SystemInfoType_UsedPhysicalMemorySize)
+        return ResultInvalidKernelEnumValue;
+
+    u64 used = g_poolBaseUsage;
+    for (const auto &[programId, pid] : g_processes) {
+        auto usage = g_memoryUsage.find(programId);
+        if (usage != g_memoryUsage.end())
+            used += usage->second;
+    }
+    *out = used;
+    return 0;
+}
+
+void svcSleepThread(s64 nano) {
+    std::this_thread::sleep_for(std::chrono::nanoseconds(nano));
+}
+
+u64 armGetSystemTick(void) {
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return armNsToTicks(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+}
+
+u64 armGetSystemTickFreq(void) {
+    return 19200000;
+}
+
+u64 armTicksToNs(u64 tick) {
+    return (tick * 625) / 12;
+}
+
+u64 armNsToTicks(u64 ns) {
+    return (ns * 12) / 625;
+}
@@ -0,0 +1,228 @@
+#include "memory_backend.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace {
+
+    constexpr Result ResultPathNotFound = MAKERESULT(Module_Fs, 1);
+    constexpr Result ResultPathAlreadyExists = MAKERESULT(Module_Fs, 2);
+    constexpr Result ResultAlreadyStarted = MAKERESULT(Module_Pm, 2);
+
+    void wait(u64 ns) {
+        if (ns > 0)
+            std::this_thread::sleep_for(std::chrono::nanoseconds(ns));
+    }
+
+}
+
+const MemoryBackend::Module *MemoryBackend::find(u64 programId) const {
+    auto module = std::find_if(this->m_modules.begin(), this->m_modules.end(), [programId](const Module &module) {
+        return module.programId == programId;
+    });
+    return module != this->m_modules.end() ? &*module : nullptr;
+}
+
+void MemoryBackend::reapExited() {
+    const u64 now = armGetSystemTick();
+    std::erase_if(this->m_exits, [&](const auto &exit) {
+        if (now < exit.second)
+            return false;
+        this->m_running.erase(exit.first);
+        return true;
+    });
+}
+
+void MemoryBackend::addModule(const Module &module) {
+    for (auto &existing : this->m_modules) {
+        if (existing.programId == module.programId && existing.root == module.root) {
+            existing = module;
+            return;
+        }
+    }
+    this->m_modules.push_back(module);
+}
+
+void MemoryBackend::removeModule(u64 programId) {
+    std::erase_if(this->m_modules, [programId](const Module &module) { return module.programId == programId; });
+    std::scoped_lock lock(this->m_processMutex);
+    this->m_running.erase(programId);
+    this->m_exits.erase(programId);
+}
+
+void MemoryBackend::writeFile(std::string_view path, std::string_view data) {
+    this->m_files.insert_or_assign(std::string(path), std::string(data));
+}
+
+void MemoryBackend::setRunning(u64 programId, bool running) {
+    std::scoped_lock lock(this->m_processMutex);
+    if (running)
+        this->m_running.insert(programId);
+    else
+        this->m_running.erase(programId);
+    this->m_exits.erase(programId);
+}
+
+u32 MemoryBackend::orderViolations() const {
+    std::scoped_lock lock(this->m_processMutex);
+    return this->m_orderViolations;
+}
+
+void MemoryBackend::setSystemPool(u64 size, u64 baseUsage) {
+    this->m_poolSize = size;
+    this->m_poolBaseUsage = baseUsage;
+}
+
+Result MemoryBackend::scan(ScanArena &arena, ModuleTable &table, ScanState &state, u32 roots) {
+    ModuleTable::Builder builder(arena);
+    for (const auto &module : this->m_modules) {
+        if ((roots & (1u << module.root)) == 0)
+            continue;
+        const std::string_view name = arena.copy(module.name);
+        if (name.size() != module.name.size() ||
+            !builder.add(module.programId, module.root, name, module.needReboot ? ModuleTable::Flag_NeedReboot : 0, module.dependencies))
+            return MAKERESULT(Module_Libnx, LibnxError_OutOfMemory);
+    }
+    if (!builder.build(table))
+        return MAKERESULT(Module_Libnx, LibnxError_OutOfMemory);
+
+    /* Nothing here changes without the listing changing too. */
+    TitleListing listing;
+    this->listTitles(listing, roots);
+    state.changed = !state.valid || listing != state.listing;
+    state.listing = listing;
+    state.valid = true;
+    return 0;
+}
+
+Result MemoryBackend::listTitles(TitleListing &listing, u32 roots) {
+    for (const auto &module : this->m_modules) {
+        if ((roots & (1u << module.root)) != 0)
+            listing.add(module.root, module.programId, ModuleSource::Toolbox, 0);
+    }
+    return 0;
+}
+
+Result MemoryBackend::scanTitles(const u64 *programIds, u32 count, ScanArena &arena, ModuleTable &table, u32 roots) {
+    ModuleTable::Builder builder(arena);
+    for (u32 i = 0; i < count; i++) {
+        /* The module from the first root, like the scan would pick. */
+        const Module *found = nullptr;
+        for (const auto &module : this->m_modules) {
+            if (module.programId == programIds[i] && (roots & (1u << module.root)) != 0 && (found == nullptr || module.root < found->root))
+                found = &module;
+        }
+        if (found == nullptr)
+            continue;
+
+        const std::string_view name = arena.copy(found->name);
+        if (name.size() != found->name.size() ||
+            !builder.add(found->programId, found->root, name, found->needReboot ? ModuleTable::Flag_NeedReboot : 0, found->dependencies))
+            return MAKERESULT(Module_Libnx, LibnxError_OutOfMemory);
+    }
+    return builder.build(table) ? 0 : MAKERESULT(Module_Libnx, LibnxError_OutOfMemory);
+}
+
+bool MemoryBackend::fileExists(const char *path) {
+    return this->m_files.contains(std::string_view(path));
+}
+
+Result MemoryBackend::readFile(const char *path, ScanArena &arena, std::string_view &data) {
+    auto file = this->m_files.find(std::string_view(path));
+    if (file == this->m_files.end())
+        return ResultPathNotFound;
+    data = arena.copy(file->second);
+    return data.size() == file->second.size() ? 0 : MAKERESULT(Module_Libnx, LibnxError_OutOfMemory);
+}
+
+Result MemoryBackend::createFile(const char *path) {
+    return this->m_files.emplace(path, std::string()).second ? 0 : ResultPathAlreadyExists;
+}
+
+Result MemoryBackend::deleteFile(const char *path) {
+    auto file = this->m_files.find(std::string_view(path));
+    if (file == this->m_files.end())
+        return ResultPathNotFound;
+    this->m_files.erase(file);
+    return 0;
+}
+
+Result MemoryBackend::createDirectory(const char *path) {
+    /* Directories aren't tracked, files can be created anywhere. */
+    return 0;
+}
+
+Result MemoryBackend::copyFile(const char *srcPath, const char *destPath) {
+    auto source = this->m_files.find(std::string_view(srcPath));
+    if (source == this->m_files.end())
+        return ResultPathNotFound;
+    this->m_files.insert_or_assign(std::string(destPath), source->second);
+    return 0;
+}
+
+Result MemoryBackend::appendFile(const char *path, std::string_view data, s64 maxSize) {
+    std::string &file = this->m_files[std::string(path)];
+    if (s64(file.size() + data.size()) > maxSize)
+        file.clear();
+    file += data;
+    return 0;
+}
+
+bool MemoryBackend::isRunning(u64 programId) {
+    std::scoped_lock lock(this->m_processMutex);
+    this->reapExited();
+    return this->m_running.contains(programId);
+}
+
+Result MemoryBackend::launchProgram(u64 programId) {
+    const Module *module = this->find(programId);
+    if (module == nullptr)
+        return ResultProcessNotFound;
+
+    wait(this->m_launchLatencyNs);
+    std::scoped_lock lock(this->m_processMutex);
+    this->reapExited();
+    for (u64 dependency : module->dependencies)
+        this->m_orderViolations += !this->m_running.contains(dependency);
+    if (!this->m_running.insert(programId).second)
+        return ResultAlreadyStarted;
+    if (module->exitAfterNs > 0)
+        this->m_exits[programId] = armGetSystemTick() + armNsToTicks(module->exitAfterNs);
+    return 0;
+}
+
+Result MemoryBackend::terminateProgram(u64 programId) {
+    wait(this->m_launchLatencyNs);
+    std::scoped_lock lock(this->m_processMutex);
+    this->reapExited();
+    this->m_exits.erase(programId);
+    return this->m_running.erase(programId) > 0 ? 0 : ResultProcessNotFound;
+}
+
+Result MemoryBackend::getMemoryUsage(u64 programId, u64 &usedBytes) {
+    std::scoped_lock lock(this->m_processMutex);
+    const Module *module = this->find(programId);
+    if (module == nullptr || !this->m_running.contains(programId))
+        return ResultProcessNotFound;
+    usedBytes = module->memoryUsage;
+    return 0;
+}
+
+Result MemoryBackend::getSystemPoolUsage(u64 &size, u64 &usedBytes) {
+    std::scoped_lock lock(this->m_processMutex);
+    size = this->m_poolSize;
+    usedBytes = this->m_poolBaseUsage;
+    for (u64 programId : this->m_running)
+        usedBytes += this->find(programId)->memoryUsage;
+    return 0;
+}
+
+Result MemoryBackend::getExosphereVersion(u64 &version) {
+    version = this->m_exosphereVersion;
+    return 0;
+}
+
+Result MemoryBackend::shutdown(bool reboot) {
+    return 0;
+}
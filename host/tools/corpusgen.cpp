@@ -0,0 +1,86 @@
+#include "corpus.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <json.hpp>
+
+namespace {
+
+    constexpr const char *const toolboxKindNames[] = { "none", "valid", "truncated", "missing_field", "wrong_type", "bad_program_id", "empty" };
+    constexpr const char *const exefsKindNames[] = { "none", "npdm", "nsp" };
+
+    bool parseArgs(int argc, char **argv, corpus::Config &config, const char *&root) {
+        bool customPayloads = false;
+        for (int i = 1; i < argc; i++) {
+            if (i + 1 >= argc)
+                return false;
+            const char *arg = argv[i];
+            const char *value = argv[++i];
+            if (std::strcmp(arg, "--out") == 0)
+                root = value;
+            else if (std::strcmp(arg, "--seed") == 0)
+                config.seed = std::strtoull(value, nullptr, 0);
+            else if (std::strcmp(arg, "--titles") == 0)
+                config.titles = std::strtoul(value, nullptr, 0);
+            else if (std::strcmp(arg, "--toolbox-min") == 0)
+                config.toolboxMinSize = std::strtoul(value, nullptr, 0);
+            else if (std::strcmp(arg, "--toolbox-max") == 0)
+                config.toolboxMaxSize = std::strtoul(value, nullptr, 0);
+            else if (std::strcmp(arg, "--sxos") == 0)
+                config.sxosPercent = std::strtoul(value, nullptr, 0);
+            else if (std::strcmp(arg, "--malformed") == 0)
+                config.malformedPercent = std::strtoul(value, nullptr, 0);
+            else if (std::strcmp(arg, "--boot2") == 0)
+                config.boot2Percent = std::strtoul(value, nullptr, 0);
+            else if (std::strcmp(arg, "--exefs") == 0)
+                config.exefsPercent = std::strtoul(value, nullptr, 0);
+            else if (std::strcmp(arg, "--payload") == 0) {
+                /* PATH=SIZE, may be given multiple times and replaces the default payloads. */
+                const char *separator = std::strchr(value, '=');
+                if (separator == nullptr)
+                    return false;
+                if (!customPayloads)
+                    config.bootPayloads.clear();
+                customPayloads = true;
+                config.bootPayloads.emplace_back(std::string(value, separator), std::strtoul(separator + 1, nullptr, 0));
+            } else
+                return false;
+        }
+        return root != nullptr;
+    }
+
+}
+
+int main(int argc, char **argv) {
+    corpus::Config config;
+    const char *root = nullptr;
+    if (!parseArgs(argc, argv, config, root)) {
+        std::fprintf(stderr, "usage: %s --out DIR [--seed N] [--titles N] [--toolbox-min BYTES] [--toolbox-max BYTES]\n"
+                             "       [--malformed PERCENT] [--boot2 PERCENT] [--exefs PERCENT] [--sxos PERCENT]\n"
+                             "       [--payload PATH=SIZE]...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    corpus::Manifest manifest = corpus::generateDirectory(config, root);
+
+    /* The manifest describes what the overlay should make of the tree. */
+    nlohmann::json titles = nlohmann::json::array();
+    for (const auto &title : manifest.titles) {
+        char tid[17];
+        std::snprintf(tid, sizeof(tid), "%016lX", title.programId);
+        titles.push_back({
+            {"tid", tid},
+            {"name", title.name},
+            {"toolbox", toolboxKindNames[u8(title.toolbox)]},
+            {"exefs", exefsKindNames[u8(title.exefs)]},
+            {"requires_reboot", title.needReboot},
+            {"boot2", title.hasFlag},
+            {"sxos_copy", title.mirrored},
+        });
+    }
+
+    std::puts(nlohmann::json({{"seed", config.seed}, {"titles", titles}, {"listed", manifest.listed().size()}}).dump(2).c_str());
+    return EXIT_SUCCESS;
+}
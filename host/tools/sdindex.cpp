@@ -0,0 +1,191 @@
+#include "fake_switch.hpp"
+#include "module_scanner.hpp"
+#include "program_id.hpp"
+#include "sysmodule.hpp"
+#include "toolbox.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include <json.hpp>
+
+/*
+ * Writes the overlay's scan index onto a mounted SD card, so the first scan on
+ * the console reuses it instead of opening every title's files. The files the
+ * scanner reads are copied into the fake SD card with their modification
+ * times, scanned by the overlay's own code and the index it saves is copied
+ * back out.
+ */
+namespace {
+
+    namespace fs = std::filesystem;
+
+    constexpr const char *const sourceNames[] = { "none", "toolbox", "exefs_nsp", "exefs" };
+
+    /* Everything the scanner and the status poll open in a title directory. */
+    constexpr const char *const titleFiles[] = { "toolbox.json", "exefs.nsp", "exefs/main.npdm" };
+
+    bool parseArgs(int argc, char **argv, const char *&root, u32 &workers, long &utcOffset, bool &localTime) {
+        for (int i = 1; i < argc; i++) {
+            if (i + 1 >= argc)
+                return false;
+            const char *arg = argv[i];
+            const char *value = argv[++i];
+            if (std::strcmp(arg, "--sd") == 0)
+                root = value;
+            else if (std::strcmp(arg, "--workers") == 0)
+                workers = std::strtoul(value, nullptr, 0);
+            else if (std::strcmp(arg, "--utc-offset") == 0)
+                utcOffset = std::strtol(value, nullptr, 0), localTime = false;
+            else
+                return false;
+        }
+        return root != nullptr;
+    }
+
+    bool readHostFile(const fs::path &path, std::string &data) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+            return false;
+        std::ostringstream contents;
+        contents << file.rdbuf();
+        data = contents.str();
+        return true;
+    }
+
+    /*
+     * FAT stores local times with 2 second granularity and the console reports
+     * them as they are stored, without any time zone. The PC converted them to
+     * UTC with the offset the card was mounted with, so that offset is added
+     * back and the odd second dropped.
+     */
+    u64 consoleTime(std::time_t seconds, long utcOffset, bool localTime) {
+        if (localTime) {
+            std::tm local = {};
+            localtime_r(&seconds, &local);
+            utcOffset = local.tm_gmtoff / 60;
+        }
+        return u64(seconds + utcOffset * 60) & ~u64(1);
+    }
+
+    /* Copies a file into the fake with the modification time the console will see for it. */
+    bool mirrorFile(const fs::path &hostPath, const std::string &path, long utcOffset, bool localTime) {
+        std::string data;
+        std::error_code ec;
+        const auto modified = fs::last_write_time(hostPath, ec);
+        if (ec || !readHostFile(hostPath, data))
+            return false;
+        fake::writeFile(path, data);
+        const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::file_clock::to_sys(modified).time_since_epoch());
+        fake::setModified(path, consoleTime(seconds.count(), utcOffset, localTime));
+        return true;
+    }
+
+    /* Why a toolbox.json wouldn't describe its title, nullptr if it does. */
+    const char *checkToolbox(const std::string &data, std::string_view titleDir) {
+        ToolboxInfo info;
+        u64 programId = 0;
+        if (!parseToolbox(data, info))
+            return "malformed";
+        if (!parseProgramId(titleDir, programId) || info.programId != programId)
+            return "tid_mismatch";
+        return nullptr;
+    }
+
+}
+
+int main(int argc, char **argv) {
+    const char *root = nullptr;
+    u32 workers = ScanWorkers;
+    long utcOffset = 0;
+    bool localTime = true;
+    if (!parseArgs(argc, argv, root, workers, utcOffset, localTime)) {
+        std::fprintf(stderr, "usage: %s --sd DIR [--workers N] [--utc-offset MINUTES]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    fake::reset();
+    nlohmann::json invalidToolboxes = nlohmann::json::array();
+    u32 mirroredFiles = 0;
+    for (const auto &contentRoot : ContentRoots) {
+        std::error_code ec;
+        const fs::path rootPath = fs::path(root) / (contentRoot.path + 1);
+        for (const auto &entry : fs::directory_iterator(rootPath, ec)) {
+            if (!entry.is_directory())
+                continue;
+            const std::string titleDir = entry.path().filename().string();
+            const std::string path = std::string(contentRoot.path) + "/" + titleDir;
+            fake::makeDirectory(path);
+
+            u64 programId;
+            if (!parseProgramId(titleDir, programId) || programId == TeslaProgramId)
+                continue;
+            for (const char *file : titleFiles)
+                mirroredFiles += mirrorFile(entry.path() / file, path + "/" + file, utcOffset, localTime);
+            mirroredFiles += mirrorFile(entry.path() / contentRoot.boot2Flag, path + "/" + contentRoot.boot2Flag, utcOffset, localTime);
+
+            std::string toolbox;
+            if (!fake::readFile(path + "/toolbox.json", toolbox))
+                continue;
+            if (const char *problem = checkToolbox(toolbox, titleDir); problem != nullptr)
+                invalidToolboxes.push_back({ {"path", path + "/toolbox.json"}, {"problem", problem} });
+        }
+    }
+
+    FsFileSystem sd;
+    fsOpenSdCardFileSystem(&sd);
+    ScanArena arena;
+    ModuleTable table;
+    if (Result rc = scanModules(&sd, arena, table, ScanIndexPath, workers); R_FAILED(rc)) {
+        std::fprintf(stderr, "scan failed: 0x%X, is %s an SD card with /atmosphere/contents?\n", rc, root);
+        return EXIT_FAILURE;
+    }
+
+    /* The index is only saved when the scan found anything, an empty card leaves nothing to copy. */
+    std::string index;
+    const fs::path indexPath = fs::path(root) / (ScanIndexPath + 1);
+    if (fake::readFile(ScanIndexPath, index)) {
+        std::error_code ec;
+        fs::create_directories(indexPath.parent_path(), ec);
+        std::ofstream file(indexPath, std::ios::binary | std::ios::trunc);
+        if (!file.write(index.data(), index.size())) {
+            std::fprintf(stderr, "failed to write %s\n", indexPath.c_str());
+            return EXIT_FAILURE;
+        }
+    }
+
+    ScanIndex written;
+    ScanArena indexArena;
+    written.load(&sd, ScanIndexPath, indexArena);
+
+    nlohmann::json modules = nlohmann::json::array();
+    for (u32 i = 0; i < table.size(); i++) {
+        char tid[ProgramIdLength + 1] = {};
+        formatProgramId(table.programId(i), tid);
+        const ScanIndex::Entry *entry = written.find(table.rootIndex(i), table.programId(i));
+        modules.push_back({
+            {"tid", tid},
+            {"name", table.name(i)},
+            {"root", table.root(i).path},
+            {"source", sourceNames[u32(entry != nullptr ? entry->source : ModuleSource::None)]},
+            {"requires_reboot", table.needReboot(i)},
+            {"boot2", fileExists(&sd, table.boot2FlagPath(i))},
+        });
+    }
+    fsFsClose(&sd);
+
+    nlohmann::json output = {
+        {"sd", root},
+        {"mirrored_files", mirroredFiles},
+        {"index", index.empty() ? nlohmann::json(nullptr) : nlohmann::json({ {"path", indexPath.string()}, {"entries", written.size()}, {"bytes", index.size()} })},
+        {"modules", modules},
+        {"invalid_toolboxes", invalidToolboxes},
+    };
+    std::printf("%s\n", output.dump(2).c_str());
+    return EXIT_SUCCESS;
+}
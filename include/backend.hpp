@@ -0,0 +1,47 @@
+#pragma once
+
+#include "module_scanner.hpp"
+
+/* What pm returns for a program that has no process, as opposed to a query that failed. */
+constexpr Result ResultProcessNotFound = MAKERESULT(Module_Pm, 1);
+
+/*
+ * Everything the overlay asks of the system, so ModuleEngine doesn't call
+ * libnx itself. LibnxBackend is the one the overlay runs on, the host tools
+ * also have one that keeps the SD card and processes in memory. Paths are
+ * absolute paths on the SD card.
+ */
+class Backend {
+  public:
+    virtual ~Backend() = default;
+
+    /* Listing and reading the title directories of the content roots in roots, see scanModules() and listTitles(). */
+    virtual Result scan(ScanArena &arena, ModuleTable &table, ScanState &state, u32 roots) = 0;
+    virtual Result listTitles(TitleListing &listing, u32 roots) = 0;
+    /* See scanTitles(). */
+    virtual Result scanTitles(const u64 *programIds, u32 count, ScanArena &arena, ModuleTable &table, u32 roots) = 0;
+
+    virtual bool fileExists(const char *path) = 0;
+    /* Reads the whole file into a buffer allocated from arena. */
+    virtual Result readFile(const char *path, ScanArena &arena, std::string_view &data) = 0;
+    /* Creates an empty file. */
+    virtual Result createFile(const char *path) = 0;
+    virtual Result deleteFile(const char *path) = 0;
+    virtual Result createDirectory(const char *path) = 0;
+    /* Replaces destPath with the contents of srcPath. */
+    virtual Result copyFile(const char *srcPath, const char *destPath) = 0;
+    /* Appends to the file, creating it. A file that would grow past maxSize is started over instead. */
+    virtual Result appendFile(const char *path, std::string_view data, s64 maxSize) = 0;
+
+    virtual bool isRunning(u64 programId) = 0;
+    virtual Result launchProgram(u64 programId) = 0;
+    virtual Result terminateProgram(u64 programId) = 0;
+    /* Fails with ResultProcessNotFound if the program isn't running. */
+    virtual Result getMemoryUsage(u64 programId, u64 &usedBytes) = 0;
+    /* Size and usage of the system memory pool, the one sysmodules are allocated from. */
+    virtual Result getSystemPoolUsage(u64 &size, u64 &usedBytes) = 0;
+
+    /* Exosphère's API version, which tells the CFW apart. */
+    virtual Result getExosphereVersion(u64 &version) = 0;
+    virtual Result shutdown(bool reboot) = 0;
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <switch.h>
+
+#include <string_view>
+
+/* A directory holding one subdirectory per title, together with where that CFW expects a title's flags. */
+struct ContentRoot {
+    const char *path;
+    /* Both relative to a title directory, the boot2 flag is inside the flags directory. */
+    const char *flagsDirectory;
+    const char *boot2Flag;
+};
+
+/* Scanned in this order, a title found in an earlier root hides the same title in later ones. */
+constexpr ContentRoot ContentRoots[] = {
+    { "/atmosphere/contents", "flags", "flags/boot2.flag" },
+    { "/sxos/titles", "flags", "flags/boot2.flag" },
+};
+
+constexpr u8 ContentRootCount = sizeof(ContentRoots) / sizeof(ContentRoots[0]);
+
+/* Sets of roots to scan, bit i stands for ContentRoots[i]. Only the running CFW loads titles from its root. */
+constexpr u32 AllContentRoots = (1u << ContentRootCount) - 1;
+constexpr u32 AtmosphereContentRoots = 1u << 0;
+constexpr u32 SxosContentRoots = 1u << 1;
+
+static_assert(std::string_view(ContentRoots[0].path) == "/atmosphere/contents" && std::string_view(ContentRoots[1].path) == "/sxos/titles");
+
+/* Module tables store only the boot2 flag path and take the flags directory from its start. */
+constexpr bool flagIsInFlagsDirectory(const ContentRoot &root) {
+    std::string_view flagsDirectory(root.flagsDirectory), boot2Flag(root.boot2Flag);
+    return boot2Flag.size() > flagsDirectory.size() && boot2Flag.starts_with(flagsDirectory) && boot2Flag[flagsDirectory.size()] == '/';
+}
+
+static_assert([] {
+    for (const auto &root : ContentRoots) {
+        if (!flagIsInFlagsDirectory(root))
+            return false;
+    }
+    return true;
+}());
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "backend.hpp"
+
+#include <algorithm>
+
+/* Where the journal is written, started over once it would grow past MaxJournalFileSize. */
+constexpr const char *const JournalPath = "/config/ovlSysmodules/journal.log";
+constexpr s64 MaxJournalFileSize = 64 * 1024;
+
+enum class JournalAction : u8 {
+    Start,
+    Stop,
+    CreateFlag,
+    DeleteFlag,
+    /* Seen by the launch tracker, no call of its own. */
+    ExitedEarly,
+    NotVisible,
+    SelectBootDat,
+    Count,
+};
+
+const char *journalActionName(JournalAction action);
+
+/*
+ * Ring buffer of what the engine did to modules and what came back. Recording
+ * is a store into a fixed array, nothing is formatted or written until
+ * flush() appends every event since the last flush to the journal file in one
+ * write. Once more than Capacity events were recorded between two flushes the
+ * oldest ones are lost. Not thread safe, events come from the thread driving
+ * the engine, or from batch workers holding the batch's lock.
+ */
+class EventJournal {
+  public:
+    static constexpr u32 Capacity = 256;
+
+    struct Event {
+        /* System tick the action started at. */
+        u64 tick;
+        u64 programId;
+        Result result;
+        u32 durationTicks;
+        JournalAction action;
+    };
+
+  private:
+    Event m_events[Capacity];
+    u64 m_recorded = 0;
+    u64 m_flushed = 0;
+
+  public:
+    void record(JournalAction action, u64 programId, Result result, u64 startTick, u64 endTick) {
+        this->m_events[this->m_recorded++ % Capacity] = { startTick, programId, result, u32(std::min<u64>(endTick - startTick, ~0u)), action };
+    }
+
+    /* Events still in the buffer, event(0) is the newest. */
+    u32 size() const { return std::min<u64>(this->m_recorded, Capacity); }
+    const Event &event(u32 age) const { return this->m_events[(this->m_recorded - 1 - age) % Capacity]; }
+    /* Events recorded since the last flush, whether they're still in the buffer or not. */
+    u64 unflushed() const { return this->m_recorded - this->m_flushed; }
+
+    /*
+     * Appends the events since the last flush to path as text, one per line:
+     * "<seconds since boot> <action> <program id> <result> <duration in us>".
+     * Does nothing if there are none.
+     */
+    Result flush(Backend &backend, const char *path);
+};
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <switch.h>
+
+#include <cstddef>
+
+/* Size of the name field in the META header of a main.npdm. */
+constexpr size_t NpdmNameLength = 0x10;
+
+/*
+ * Both read the process name out of a main.npdm with a couple of small fixed
+ * size reads instead of loading the file. name receives up to NpdmNameLength
+ * bytes, not terminated, and length how many of them are used.
+ */
+Result readNpdmName(FsFileSystem *fs, const char *path, char *name, size_t &length);
+/* Looks up main.npdm in the file table of an exefs.nsp and reads the name from there. */
+Result readNspNpdmName(FsFileSystem *fs, const char *path, char *name, size_t &length);
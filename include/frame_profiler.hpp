@@ -0,0 +1,46 @@
+#pragma once
+
+#include <switch.h>
+
+/*
+ * Update and draw times of the last Frames frames, for the profiler strip.
+ * Nothing is measured while it's disabled, the callers check enabled() before
+ * reading the clock. Frame times are kept in ticks and only converted when
+ * summarized.
+ */
+class FrameProfiler {
+  public:
+    static constexpr u32 Frames = 128;
+
+    struct Summary {
+        u32 frames;
+        u64 lastUpdateNs;
+        u64 lastDrawNs;
+        /* Of update plus draw time, over the frames kept. */
+        u64 p50Ns;
+        u64 p99Ns;
+        u64 maxNs;
+    };
+
+  private:
+    u32 m_updateTicks[Frames];
+    u32 m_drawTicks[Frames];
+    u32 m_next = 0;
+    u32 m_count = 0;
+    u32 m_pendingUpdateTicks = 0;
+    bool m_enabled = false;
+
+  public:
+    bool enabled() const { return this->m_enabled; }
+    /* Turning it on starts with an empty history. */
+    void setEnabled(bool enabled);
+
+    /* update() runs before the frame is drawn, so its time waits for the draw that completes the frame. */
+    void recordUpdate(u64 ticks) { this->m_pendingUpdateTicks = ticks; }
+    void recordDraw(u64 ticks);
+
+    u32 count() const { return this->m_count; }
+    /* Update plus draw time of a frame, frameNs(0) is the last one. */
+    u64 frameNs(u32 age) const;
+    Summary summarize() const;
+};
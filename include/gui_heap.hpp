@@ -0,0 +1,17 @@
+#pragma once
+
+#include "heap_stats.hpp"
+
+#include <tesla.hpp>
+
+/* Diagnostics page showing the heap usage of the overlay. */
+class GuiHeap : public tsl::Gui {
+  private:
+    HeapStats m_stats;
+
+  public:
+    GuiHeap();
+
+    virtual tsl::elm::Element *createUI() override;
+    virtual void update() override;
+};
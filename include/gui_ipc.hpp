@@ -0,0 +1,19 @@
+#pragma once
+
+#include "ipc_stats.hpp"
+
+#include <tesla.hpp>
+
+/* Diagnostics page showing how often the overlay called each service and how long the calls took. */
+class GuiIpc : public tsl::Gui {
+  private:
+    IpcCallStats m_stats[u32(IpcCall::Count)];
+
+    void refresh();
+
+  public:
+    GuiIpc();
+
+    virtual tsl::elm::Element *createUI() override;
+    virtual void update() override;
+};
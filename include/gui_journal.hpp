@@ -0,0 +1,20 @@
+#pragma once
+
+#include "module_engine.hpp"
+#include "virtual_list.hpp"
+
+#include <tesla.hpp>
+
+/* Diagnostics page listing the event journal, newest first. */
+class GuiJournal : public tsl::Gui {
+  private:
+    ModuleEngine &m_engine;
+    VirtualList *m_list = nullptr;
+    u32 m_shownSize = 0;
+
+  public:
+    explicit GuiJournal(ModuleEngine &engine);
+
+    virtual tsl::elm::Element *createUI() override;
+    virtual void update() override;
+};
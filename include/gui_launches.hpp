@@ -0,0 +1,17 @@
+#pragma once
+
+#include "module_engine.hpp"
+
+#include <tesla.hpp>
+
+/* Diagnostics page comparing how long recent module launches took and whether they kept running. */
+class GuiLaunches : public tsl::Gui {
+  private:
+    ModuleEngine &m_engine;
+
+  public:
+    explicit GuiLaunches(ModuleEngine &engine);
+
+    virtual tsl::elm::Element *createUI() override;
+    virtual void update() override;
+};
@@ -1,36 +1,54 @@
 #pragma once
 
-#include <list>
+#include "frame_profiler.hpp"
+#include "libnx_backend.hpp"
+#include "module_engine.hpp"
+#include "virtual_list.hpp"
+
 #include <tesla.hpp>
 
-struct SystemModule {
-    tsl::elm::ListItem *listItem;
-    u64 programId;
-    bool needReboot;
-};
-enum class BootDatType {
-    SXOS_BOOT_TYPE,
-    SXGEAR_BOOT_TYPE
-};
+#include <string>
+#include <vector>
+
+/* A view over the module engine, all it does itself is lay out the lists and react to buttons. */
 class GuiMain : public tsl::Gui {
   private:
-    FsFileSystem m_fs;
-    std::list<SystemModule> m_sysmoduleListItems;
+    LibnxBackend m_backend;
+    ModuleEngine m_engine;
+    /* The memory column costs a few calls per module and second, so it's off until asked for. */
+    bool m_showMemory = false;
+    FrameProfiler m_profiler;
+    /* Modules matching m_query in the order the search found them, the dynamic ones first. Unused while the query is empty. */
+    std::string m_query;
+    std::vector<u32> m_found;
+    std::vector<u32> m_matches;
+    u32 m_dynamicMatches = 0;
+    u32 m_searchChar = 0;
+    VirtualList *m_dynamicList = nullptr;
+    VirtualList *m_staticList = nullptr;
     tsl::elm::ListItem *m_listItemSXOSBootType;
     tsl::elm::ListItem *m_listItemSXGEARBootType;
-    bool m_scanned;
 
   public:
     GuiMain();
-    ~GuiMain();
+    virtual ~GuiMain();
 
     virtual tsl::elm::Element *createUI();
     virtual void update() override;
 
   private:
-    void updateStatus(const SystemModule &module);
-    bool hasFlag(const SystemModule &module);
-    bool isRunning(const SystemModule &module);
-    Result CopyFile(const char *srcPath, const char *destPath);
-    BootDatType m_bootRunning;
+    VirtualList *createModuleList(bool dynamic);
+    u32 listModule(bool dynamic, u32 index) const;
+    u32 listCount(bool dynamic) const;
+    void poll();
+    /* Asks for the status of the list's bound rows, only of the ones without one unless all is set. Returns whether it asked for any. */
+    bool pollStatus(VirtualList *list, bool dynamic, bool all);
+    void rescan();
+    void updateList(VirtualList *list, bool dynamic, u64 cursorProgramId);
+    u64 cursorProgramId(VirtualList *list, bool dynamic) const;
+    void filter();
+    bool onSearchClick(tsl::elm::ListItem *item, u64 click);
+    bool onModuleClick(u32 module, u64 click);
+    void refreshLists();
+    void drawMemoryBudget(tsl::gfx::Renderer *renderer, s32 x, s32 y);
 };
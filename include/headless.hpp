@@ -0,0 +1,44 @@
+#pragma once
+
+#include "backend.hpp"
+
+#include <string_view>
+
+/*
+ * Profiles are ProfileDirectory/<name>.txt, one "start <program id>" or
+ * "stop <program id>" per line. Empty lines and lines starting with # are
+ * skipped.
+ */
+constexpr const char *const ProfileDirectory = "/config/ovlSysmodules/profiles";
+
+/* More than any profile should need, the actions of one run are kept on the stack. */
+constexpr u32 MaxHeadlessActions = 64;
+/* The named modules plus the dependencies of those that are started. */
+constexpr u32 MaxHeadlessModules = 128;
+/* What runHeadless() returns for a flag it doesn't know or one without its value, nothing is applied then. */
+constexpr u32 HeadlessUsageError = ~0u;
+
+struct HeadlessAction {
+    u64 programId;
+    bool start;
+};
+
+/* Whether argv asks for a headless run: --profile NAME, --start TID or --stop TID, any number of them. */
+bool isHeadlessLaunch(int argc, char **argv);
+
+/*
+ * Appends the actions of a profile to actions. Returns false if a line doesn't
+ * parse or there are too many, count is left as it was then.
+ */
+bool parseProfile(std::string_view data, HeadlessAction *actions, u32 &count);
+
+/*
+ * Applies the arguments, only looking at the modules they name and what
+ * those depend on instead of scanning all of them. The last action for a
+ * module wins, the stops are applied first and then the starts, in
+ * dependency order. Boot2 flags stay as they are. Returns how many arguments
+ * or modules couldn't be applied, dependencies that don't fit in
+ * MaxHeadlessModules and aren't running included, 0 if everything went
+ * through, or HeadlessUsageError if the arguments aren't a valid command line.
+ */
+u32 runHeadless(Backend &backend, int argc, char **argv);
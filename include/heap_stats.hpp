@@ -0,0 +1,51 @@
+#pragma once
+
+#include <switch.h>
+
+/*
+ * Heap accounting for the overlay process. The counters are fed by the
+ * __wrap_ allocator functions in heap_stats.cpp, which the Makefile routes
+ * malloc, free, their newlib _r versions and friends through with -Wl,--wrap.
+ * operator new ends up in malloc, so C++ allocations are covered too. Sizes
+ * are the usable sizes the allocator hands out, not the requested ones.
+ */
+struct HeapStats {
+    /* Bucket i counts allocations of [2^(i+3), 2^(i+4)) bytes, the first and last ones are open ended. */
+    static constexpr u32 Buckets = 16;
+
+    u64 currentBytes;
+    u64 peakBytes;
+    u64 allocations;
+    u64 frees;
+    u64 histogram[Buckets];
+
+    static constexpr u64 bucketFloor(u32 bucket) {
+        return bucket == 0 ? 0 : u64(1) << (bucket + 3);
+    }
+
+    /* True if the allocator wrappers are linked in and have seen any traffic. */
+    bool instrumented() const { return this->allocations > 0; }
+};
+
+/* A snapshot taken at the end of one phase of the overlay's life. */
+struct HeapCheckpoint {
+    u64 currentBytes;
+    /* Highest usage since the previous checkpoint. */
+    u64 peakBytes;
+    u64 allocations;
+    bool taken;
+};
+
+enum class HeapPhase : u8 {
+    Scan,
+    CreateUI,
+    Count,
+};
+
+void getHeapStats(HeapStats &stats);
+/* Lets the next peak be measured from the current usage. */
+void resetHeapPeak();
+
+/* Stores the usage and peak of the phase that just ended and starts a new peak. */
+void recordHeapPhase(HeapPhase phase);
+const HeapCheckpoint &getHeapPhase(HeapPhase phase);
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <switch.h>
+
+#include <type_traits>
+#include <utility>
+
+/*
+ * Counters and latency histograms of every service call the overlay makes.
+ * Call sites go through ipcCall(), which times the call and adds it to the
+ * counters of its IpcCall. The counters are relaxed atomics, the scan workers
+ * make calls concurrently.
+ */
+enum class IpcCall : u8 {
+    FsOpenSdCardFileSystem,
+    FsOpenDirectory,
+    FsDirRead,
+    FsDirClose,
+    FsOpenFile,
+    FsFileRead,
+    FsFileWrite,
+    FsFileGetSize,
+    FsFileClose,
+    FsCreateFile,
+    FsDeleteFile,
+    FsCreateDirectory,
+    FsGetFileTimeStamp,
+    PmdmntGetProcessId,
+    PmdmntGetProcessInfo,
+    PmshellLaunchProgram,
+    PmshellTerminateProgram,
+    SvcGetInfo,
+    SvcGetSystemInfo,
+    SplGetConfig,
+    SpsmShutdown,
+    Count,
+};
+
+struct IpcCallStats {
+    /* Bucket i counts calls of [2^(i-1), 2^i) microseconds, the first and last ones are open ended. */
+    static constexpr u32 Buckets = 16;
+
+    u64 calls;
+    u64 failures;
+    u64 totalNs;
+    u64 maxNs;
+    u64 histogram[Buckets];
+
+    static constexpr u64 bucketFloorUs(u32 bucket) {
+        return bucket == 0 ? 0 : u64(1) << (bucket - 1);
+    }
+};
+
+/* The libnx function's name, "fsFsOpenFile". */
+const char *ipcCallName(IpcCall call);
+void recordIpcCall(IpcCall call, u64 ticks, bool failed);
+void getIpcStats(IpcCall call, IpcCallStats &stats);
+void resetIpcStats();
+
+/* Calls function with args and counts it as call. Calls that return nothing can't fail. */
+template <typename R, typename... Params, typename... Args>
+R ipcCall(IpcCall call, R (*function)(Params...), Args &&...args) {
+    const u64 start = armGetSystemTick();
+    if constexpr (std::is_void_v<R>) {
+        function(std::forward<Args>(args)...);
+        recordIpcCall(call, armGetSystemTick() - start, false);
+    } else {
+        R result = function(std::forward<Args>(args)...);
+        recordIpcCall(call, armGetSystemTick() - start, R_FAILED(result));
+        return result;
+    }
+}
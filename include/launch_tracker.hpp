@@ -0,0 +1,68 @@
+#pragma once
+
+#include "backend.hpp"
+
+/*
+ * Watches modules right after they were launched. A successful launch only
+ * means pm created the process, so every launch is polled for a short window:
+ * until the process shows up, which gives the launch latency, and then until
+ * the window ends, to catch a module that exits right after starting. What it
+ * saw is kept per module, so launches can be compared later on.
+ */
+class LaunchTracker {
+  public:
+    static constexpr u64 DefaultWindowNs = 3'000'000'000;
+    /* Modules launches are remembered for, the oldest finished one makes room. */
+    static constexpr u32 MaxRecords = 32;
+
+    enum class Outcome : u8 {
+        /* Still in its window, shown or not yet. */
+        Watching,
+        /* Ran for the whole window. */
+        Running,
+        /* Was seen running and went away within the window. */
+        ExitedEarly,
+        /* Never showed up within the window. */
+        NotVisible,
+        /* Stopped on purpose within the window. */
+        Stopped,
+    };
+
+    struct Record {
+        u64 programId;
+        Outcome outcome;
+        bool visible;
+        u32 launches;
+        u32 earlyExits;
+        /* From the launch call to the process being seen, 0 until it was. */
+        u64 latencyNs;
+        u64 bestLatencyNs;
+        u64 launchTick;
+    };
+
+  private:
+    u64 m_windowTicks;
+    Record m_records[MaxRecords];
+    u32 m_count = 0;
+    u32 m_watching = 0;
+
+  public:
+    explicit LaunchTracker(u64 windowNs = DefaultWindowNs);
+
+    /* launchTick is from right before the launch call, which had to succeed. */
+    void launched(u64 programId, u64 launchTick);
+    /* The module was terminated on purpose, so its window ends without counting an early exit. */
+    void stopped(u64 programId);
+    /*
+     * Asks the backend about every module still in its window. Returns whether
+     * one showed up or its window closed. Does nothing while none is watched,
+     * so it can be called on every frame.
+     */
+    bool poll(Backend &backend);
+
+    bool watching() const { return this->m_watching > 0; }
+    /* nullptr if the module wasn't launched, or not recently enough to be remembered. */
+    const Record *find(u64 programId) const;
+    const Record *records() const { return this->m_records; }
+    u32 count() const { return this->m_count; }
+};
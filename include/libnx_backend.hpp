@@ -0,0 +1,40 @@
+#pragma once
+
+#include "backend.hpp"
+
+/* The backend the overlay runs on, the files are on the SD card. */
+class LibnxBackend final : public Backend {
+  private:
+    FsFileSystem m_fs;
+    bool m_open = false;
+
+  public:
+    LibnxBackend() = default;
+    LibnxBackend(const LibnxBackend &) = delete;
+    LibnxBackend &operator=(const LibnxBackend &) = delete;
+    ~LibnxBackend();
+
+    /* Opens the services and the SD card, nothing else works if this fails. */
+    Result initialize();
+
+    Result scan(ScanArena &arena, ModuleTable &table, ScanState &state, u32 roots) override;
+    Result listTitles(TitleListing &listing, u32 roots) override;
+    Result scanTitles(const u64 *programIds, u32 count, ScanArena &arena, ModuleTable &table, u32 roots) override;
+
+    bool fileExists(const char *path) override;
+    Result readFile(const char *path, ScanArena &arena, std::string_view &data) override;
+    Result createFile(const char *path) override;
+    Result deleteFile(const char *path) override;
+    Result createDirectory(const char *path) override;
+    Result copyFile(const char *srcPath, const char *destPath) override;
+    Result appendFile(const char *path, std::string_view data, s64 maxSize) override;
+
+    bool isRunning(u64 programId) override;
+    Result launchProgram(u64 programId) override;
+    Result terminateProgram(u64 programId) override;
+    Result getMemoryUsage(u64 programId, u64 &usedBytes) override;
+    Result getSystemPoolUsage(u64 &size, u64 &usedBytes) override;
+
+    Result getExosphereVersion(u64 &version) override;
+    Result shutdown(bool reboot) override;
+};
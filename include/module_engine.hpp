@@ -0,0 +1,124 @@
+#pragma once
+
+#include "backend.hpp"
+#include "event_journal.hpp"
+#include "launch_tracker.hpp"
+#include "module_search.hpp"
+#include "module_usage.hpp"
+#include "work_pool.hpp"
+
+enum class BootDatType {
+    SXOS_BOOT_TYPE,
+    SXGEAR_BOOT_TYPE
+};
+
+/* Why a module wasn't started or stopped, besides what the backend returned. */
+constexpr Result ResultModuleNeedsReboot = MAKERESULT(Module_Libnx, LibnxError_BadInput);
+constexpr Result ResultDependencyNotRunning = MAKERESULT(Module_Libnx, LibnxError_NotFound);
+constexpr Result ResultDependencyCycle = MAKERESULT(Module_Libnx, LibnxError_IoError);
+
+/*
+ * The module logic of the overlay without its UI: scanning, polling, starting
+ * and stopping modules, their boot2 flags and the memory estimate. Everything
+ * goes through the backend, so the same logic runs on the console and headless
+ * on the host.
+ */
+class ModuleEngine {
+  public:
+    /* Launches and terminations of one batch run on up to this many threads. */
+    static constexpr u32 BatchWorkers = WorkPool::MaxWorkers;
+
+    struct BatchResult {
+        /* Modules the batch started or stopped, dependencies it started included. */
+        u32 changed = 0;
+        u32 failed = 0;
+    };
+
+  private:
+    Backend &m_backend;
+    ScanArena m_arena;
+    ModuleTable m_modules;
+    ModuleSearch m_search;
+    ScanState m_scanState;
+    UsageSampler m_usage;
+    LaunchTracker m_launches;
+    EventJournal m_journal;
+    BootDatType m_bootDat = BootDatType::SXOS_BOOT_TYPE;
+    /* The content roots the running CFW loads titles from, see content_root.hpp. */
+    u32 m_roots = AllContentRoots;
+    bool m_scanned = false;
+
+    void createFlagsDirectory(u32 module);
+    Result setAutoStart(u32 module, bool enabled);
+    BatchResult runBatch(const u32 *modules, u32 count, bool start, Result *results, u32 workers);
+    BatchResult runSelected(bool start);
+
+  public:
+    explicit ModuleEngine(Backend &backend, u64 sampleIntervalNs = UsageSampler::DefaultIntervalNs, u64 launchWindowNs = LaunchTracker::DefaultWindowNs);
+    ModuleEngine(const ModuleEngine &) = delete;
+    ModuleEngine &operator=(const ModuleEngine &) = delete;
+
+    /*
+     * Tells the CFW apart and scans the modules in its content root. Nothing is scanned on a CFW it doesn't
+     * know, one whose version can't be read is scanned in every root with the SXOS boot file.
+     */
+    Result initialize();
+    /*
+     * Scans again if titles were added or removed since the last scan. Returns
+     * whether the table changed, module indices from before don't apply then.
+     * Selections are kept for the modules that are still there.
+     */
+    bool rescan();
+    /* Replaces the table with just these titles, see scanTitles(). Later rescans scan everything again. */
+    Result loadTitles(const u64 *programIds, u32 count);
+
+    Backend &backend() { return this->m_backend; }
+    const ModuleTable &modules() const { return this->m_modules; }
+    /* Rebuilt with every scan, see ModuleSearch. */
+    const ModuleSearch &search() const { return this->m_search; }
+    const UsageSampler &usage() const { return this->m_usage; }
+    const LaunchTracker &launches() const { return this->m_launches; }
+    const EventJournal &journal() const { return this->m_journal; }
+    bool scanned() const { return this->m_scanned; }
+    BootDatType bootDat() const { return this->m_bootDat; }
+    /* Index of the module with this program id, modules().size() if there's none. */
+    u32 find(u64 programId) const;
+
+    /* Asks the backend whether the module runs and has its boot2 flag. */
+    void updateStatus(u32 module);
+    /* Rate limited, see UsageSampler. Returns whether a sample was taken. */
+    bool sampleUsage() { return this->m_usage.sample(this->m_modules, this->m_backend); }
+    void invalidateUsage() { this->m_usage.invalidate(); }
+    /*
+     * Follows up on modules launched within the last few seconds, see
+     * LaunchTracker. A module that exited early is marked as stopped. Returns
+     * whether anything changed, cheap once nothing is watched anymore.
+     */
+    bool pollLaunches();
+
+    /* Stops a running module and removes its boot2 flag, or starts it with its dependencies and creates the flag. */
+    Result toggleRunning(u32 module);
+    /*
+     * Starts the modules along with every dependency of theirs that isn't
+     * running, in dependency order: a module is launched, alongside whatever
+     * else is ready, as soon as the launches of its dependencies returned. A module whose dependency isn't a module that can be started
+     * and isn't running, failed to start or is part of a cycle isn't started, neither is
+     * a module that needs a reboot. Boot2 flags stay as they are.
+     * results, if set, gets the outcome for each of modules.
+     */
+    BatchResult startModules(const u32 *modules, u32 count, Result *results = nullptr, u32 workers = BatchWorkers);
+    /* Stops the modules, each one only once none of the others that still run depends on it. */
+    BatchResult stopModules(const u32 *modules, u32 count, Result *results = nullptr, u32 workers = BatchWorkers);
+    BatchResult startSelected() { return this->runSelected(true); }
+    BatchResult stopSelected() { return this->runSelected(false); }
+    /* Creates or removes the boot2 flag, which decides whether the module starts with the console. */
+    Result toggleAutoStart(u32 module);
+    /* Picks the module for the memory estimate, or drops it. */
+    void toggleSelected(u32 module);
+
+    /* Copies the CFW's boot.dat over the one the console boots. */
+    Result selectBootDat(BootDatType type);
+
+    /* Appends what was done since the last flush to JournalPath, meant for when the overlay exits. */
+    Result flushJournal();
+};
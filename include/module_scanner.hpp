@@ -0,0 +1,69 @@
+#pragma once
+
+#include "module_table.hpp"
+#include "scan_index.hpp"
+
+#include <string_view>
+
+/* Title directories are looked into by this many threads, waiting on the SD card overlaps. */
+constexpr u32 ScanWorkers = 3;
+
+/*
+ * Identifies the program id directories of every root and the file each one
+ * would be described by, to notice added, removed or rewritten titles without
+ * reading them.
+ */
+struct TitleListing {
+    u32 count = 0;
+    u64 hash = 0;
+
+    /* source is the first file of the title that exists, in the order a scan prefers them, modified its modification time. */
+    void add(u8 root, u64 programId, ModuleSource source, u64 modified);
+    bool operator==(const TitleListing &other) const = default;
+};
+
+/* What a scan leaves for the next one. The index points into the arena of the scan that made it. */
+struct ScanState {
+    ScanIndex index;
+    TitleListing listing;
+    /* Set once a scan filled in the state. */
+    bool valid = false;
+    /* Whether the last scan found anything the one before it didn't. */
+    bool changed = false;
+};
+
+/*
+ * Builds the module table from the title directories of the content roots in
+ * roots, a title found in more than one root is listed once, from the first
+ * root it's in. Only directories named after a program id are looked into. A module is
+ * described by its toolbox.json, which has to name the same id, or else by the
+ * main.npdm in its exefs.nsp or exefs directory. Modules found through their
+ * exefs are listed as static since nothing says they can be started at runtime.
+ *
+ * The table and every string it references are allocated from arena, releasing
+ * the arena discards the whole scan. If indexPath is set, unchanged modules are
+ * taken from the scan index there and the index is updated when anything changed.
+ * Title directories are probed on up to workers threads, the table comes out
+ * the same however many there are.
+ */
+Result scanModules(FsFileSystem *fs, ScanArena &arena, ModuleTable &table, const char *indexPath = ScanIndexPath, u32 workers = ScanWorkers, u32 roots = AllContentRoots);
+
+/*
+ * Same as above, but keeps the scan's index in state and starts from it when
+ * state already holds a previous scan, so a rescan only opens the files of new
+ * or changed titles. table and the new state are allocated from arena, the
+ * previous scan's arena can be released once this returns. state is only
+ * updated if the scan succeeds.
+ */
+Result scanModules(FsFileSystem *fs, ScanArena &arena, ModuleTable &table, ScanState &state, const char *indexPath = ScanIndexPath, u32 workers = ScanWorkers, u32 roots = AllContentRoots);
+
+/*
+ * Builds a table of only the given titles, each from the first root that
+ * describes it, without listing the roots or using the index. For changing a
+ * few modules without paying for a whole scan. Ids that aren't modules are
+ * left out.
+ */
+Result scanTitles(FsFileSystem *fs, const u64 *programIds, u32 count, ScanArena &arena, ModuleTable &table, u32 roots = AllContentRoots);
+
+/* Lists the title directories like a scan would, with one modification time query per file checked and without opening any. */
+Result listTitles(FsFileSystem *fs, TitleListing &listing, u32 roots = AllContentRoots);
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "module_table.hpp"
+#include "scan_arena.hpp"
+
+#include <string_view>
+
+/* Longest query that's looked up, longer ones are cut. */
+constexpr u32 MaxSearchLength = 32;
+
+/*
+ * Prefix index over the names and program ids of a module table. Every module
+ * has a key for its name, one for each word of its name after the first and
+ * one for its program id in hex, all lowercase and sorted, so the modules
+ * matching a prefix are the keys of one range, found with a binary search.
+ * Built once per scan, the keys point into the arena it's built in.
+ */
+class ModuleSearch {
+  private:
+    struct Key {
+        std::string_view text;
+        u32 module;
+        /*
+         * Length of the prefix this key shares with the module's previous key
+         * in sorted order. A query no longer than that found the module
+         * through the earlier key already.
+         */
+        u8 shared;
+    };
+
+    const Key *m_keys = nullptr;
+    u32 m_count = 0;
+
+  public:
+    bool build(const ModuleTable &table, ScanArena &arena);
+
+    /*
+     * Writes the modules with a name, a word of it or a program id starting
+     * with prefix to modules, ignoring case, each once and ordered by the key
+     * they matched. Stops after capacity of them. Takes a binary search and a
+     * step per key matched, no matter how large the table is. Returns how
+     * many were written, an empty prefix matches nothing.
+     */
+    u32 find(std::string_view prefix, u32 *modules, u32 capacity) const;
+    u32 keyCount() const { return this->m_count; }
+};
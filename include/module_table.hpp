@@ -0,0 +1,142 @@
+#pragma once
+
+#include "content_root.hpp"
+#include "scan_arena.hpp"
+
+#include <span>
+#include <string_view>
+
+/*
+ * Structure-of-arrays store of the scanned sysmodules. The dynamic modules
+ * occupy [0, dynamicCount()) and the static ones, which need a reboot to take
+ * effect, [dynamicCount(), size()), both in scan order. Every program id occurs
+ * once. The boot2 flag path of each module is built along with the table, so
+ * polling and toggling don't format anything. All columns live in the arena of
+ * the scan that built the table, which owns them.
+ */
+class ModuleTable {
+  public:
+    enum Flags : u8 {
+        Flag_NeedReboot = 1 << 0,
+        /* Found through its exefs, no toolbox.json describes it. */
+        Flag_NoToolbox = 1 << 1,
+    };
+
+    enum State : u8 {
+        State_Running = 1 << 0,
+        State_Boot2Flag = 1 << 1,
+        /* Picked in the list for the memory estimate, survives status updates. */
+        State_Selected = 1 << 2,
+        /* Set once setState() filled in the status, a new table has none. */
+        State_Known = 1 << 3,
+    };
+
+    /* Collects modules during a scan and lays them out as a table once it's done. */
+    class Builder {
+      private:
+        struct Record {
+            Record *next;
+            u64 programId;
+            std::string_view name;
+            std::span<const u64> dependencies;
+            u8 root;
+            u8 flags;
+            bool hidden;
+        };
+
+        ScanArena &m_arena;
+        /* Records are only needed until build(), so they don't take up room in the table's arena. */
+        ScanArena m_records;
+        Record *m_head = nullptr;
+        Record *m_tail = nullptr;
+        u32 m_count = 0;
+
+      public:
+        explicit Builder(ScanArena &arena) : m_arena(arena) {}
+
+        /*
+         * name has to outlive the table, usually by being allocated from the same arena, dependencies only
+         * build() since they're copied. root indexes ContentRoots.
+         */
+        bool add(u64 programId, u8 root, std::string_view name, u8 flags, std::span<const u64> dependencies = {});
+        /* Of modules added more than once, the first one is kept. Returns false if the arena ran out of memory. */
+        bool build(ModuleTable &table);
+    };
+
+  private:
+    u64 *m_programIds = nullptr;
+    u8 *m_flags = nullptr;
+    u8 *m_roots = nullptr;
+    u8 *m_state = nullptr;
+    /* Last sampled memory usage of running modules, in KiB so it fits 32 bits. UnknownMemoryKiB if the sample failed. */
+    u32 *m_memoryKiB = nullptr;
+    std::string_view *m_names = nullptr;
+    /* Terminated paths packed back to back, each module has an offset into them. */
+    char *m_paths = nullptr;
+    u32 *m_pathOffsets = nullptr;
+    /* Packed like the paths, module i's are [m_dependencyOffsets[i], m_dependencyOffsets[i + 1]). */
+    u64 *m_dependencies = nullptr;
+    u32 *m_dependencyOffsets = nullptr;
+    u32 m_size = 0;
+    u32 m_dynamicCount = 0;
+    /* Kept up to date by the setters, so totals never need a pass over the table. */
+    u64 m_totalMemoryKiB = 0;
+    u64 m_selectedMemoryKiB = 0;
+    u32 m_selectedCount = 0;
+
+    static constexpr u32 UnknownMemoryKiB = ~0u;
+
+    /* What the module adds to the totals, unknown usage adds nothing. */
+    u32 countedMemoryKiB(u32 index) const { return this->m_memoryKiB[index] != UnknownMemoryKiB ? this->m_memoryKiB[index] : 0; }
+
+  public:
+    /* Usage of a module whose process couldn't be queried. */
+    static constexpr u64 UnknownMemoryUsage = ~0ull;
+
+    u32 size() const { return this->m_size; }
+    bool empty() const { return this->m_size == 0; }
+    u32 dynamicCount() const { return this->m_dynamicCount; }
+    u32 staticBegin() const { return this->m_dynamicCount; }
+    u32 staticCount() const { return this->m_size - this->m_dynamicCount; }
+
+    const u64 *programIds() const { return this->m_programIds; }
+    u64 programId(u32 index) const { return this->m_programIds[index]; }
+    std::string_view name(u32 index) const { return this->m_names[index]; }
+    bool needReboot(u32 index) const { return this->m_flags[index] & Flag_NeedReboot; }
+    u8 rootIndex(u32 index) const { return this->m_roots[index]; }
+    const ContentRoot &root(u32 index) const { return ContentRoots[this->m_roots[index]]; }
+
+    /* Program ids the module's toolbox.json says have to run before it starts. */
+    std::span<const u64> dependencies(u32 index) const {
+        return std::span<const u64>(this->m_dependencies + this->m_dependencyOffsets[index], this->m_dependencies + this->m_dependencyOffsets[index + 1]);
+    }
+
+    const char *boot2FlagPath(u32 index) const { return this->m_paths + this->m_pathOffsets[index]; }
+    /* The flags directory is the start of the boot2 flag path, this is its length. */
+    size_t flagsDirectoryLength(u32 index) const;
+
+    u8 state(u32 index) const { return this->m_state[index]; }
+    bool running(u32 index) const { return this->m_state[index] & State_Running; }
+    bool hasFlag(u32 index) const { return this->m_state[index] & State_Boot2Flag; }
+    bool selected(u32 index) const { return this->m_state[index] & State_Selected; }
+    bool statusKnown(u32 index) const { return this->m_state[index] & State_Known; }
+    void setState(u32 index, bool running, bool hasFlag) {
+        this->m_state[index] = (this->m_state[index] & State_Selected) | State_Known | (running ? State_Running : 0) | (hasFlag ? State_Boot2Flag : 0);
+    }
+    void setRunning(u32 index, bool running) {
+        this->m_state[index] = (this->m_state[index] & ~State_Running) | (running ? State_Running : 0);
+    }
+    void setHasFlag(u32 index, bool hasFlag) {
+        this->m_state[index] = (this->m_state[index] & ~State_Boot2Flag) | (hasFlag ? State_Boot2Flag : 0);
+    }
+    void setSelected(u32 index, bool selected);
+
+    /* 0 until a module was sampled while running, UnknownMemoryUsage if its last sample failed, see UsageSampler. */
+    u64 memoryUsage(u32 index) const { return this->m_memoryKiB[index] != UnknownMemoryKiB ? u64(this->m_memoryKiB[index]) * 1024 : UnknownMemoryUsage; }
+    void setMemoryUsage(u32 index, u64 bytes);
+
+    /* Sums of the sampled usage of all modules and of the selected ones, which is what stopping them would free. Unknown usage is left out. */
+    u64 totalMemoryUsage() const { return this->m_totalMemoryKiB * 1024; }
+    u64 selectedMemoryUsage() const { return this->m_selectedMemoryKiB * 1024; }
+    u32 selectedCount() const { return this->m_selectedCount; }
+};
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "backend.hpp"
+
+/*
+ * Keeps the memory usage column of a module table up to date. A sample asks
+ * for every module of the table in one pass, which also refreshes whether it
+ * runs, along with the usage of the system pool, and is taken at most once per
+ * interval. Everything shown in between comes from the table and the sampler.
+ */
+class UsageSampler {
+  public:
+    static constexpr u64 DefaultIntervalNs = 1'000'000'000;
+
+  private:
+    u64 m_intervalTicks;
+    u64 m_lastTick = 0;
+    bool m_sampled = false;
+    u64 m_poolSize = 0;
+    u64 m_poolUsed = 0;
+
+  public:
+    explicit UsageSampler(u64 intervalNs = DefaultIntervalNs);
+
+    /* Takes a sample if the last one is older than the interval. Returns whether it did. */
+    bool sample(ModuleTable &table, Backend &backend);
+    /* Makes the next sample() go through, for a new table or a module that was just started or stopped. */
+    void invalidate() { this->m_sampled = false; }
+
+    /* As of the last sample, 0 if the pool couldn't be queried. */
+    u64 poolSize() const { return this->m_poolSize; }
+    u64 poolUsed() const { return this->m_poolUsed; }
+    u64 poolHeadroom() const { return this->m_poolSize > this->m_poolUsed ? this->m_poolSize - this->m_poolUsed : 0; }
+};
+
+/*
+ * Memory usage of every program in programIds, 0 for the ones that aren't
+ * running and ModuleTable::UnknownMemoryUsage for the ones whose query failed.
+ * Returns how many are known to run.
+ */
+u32 sampleMemoryUsage(Backend &backend, const u64 *programIds, u32 count, u64 *usedBytes);
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "frame_profiler.hpp"
+
+#include <tesla.hpp>
+
+/*
+ * OverlayFrame that times its own drawing for the profiler and, while the
+ * profiler is enabled, draws a strip with the last frames' times over the
+ * bottom of the list. Disabled, it draws like a plain OverlayFrame.
+ */
+class ProfiledFrame : public tsl::elm::OverlayFrame {
+  private:
+    FrameProfiler &m_profiler;
+
+    void drawStrip(tsl::gfx::Renderer *renderer);
+
+  public:
+    ProfiledFrame(const std::string &title, const std::string &subtitle, FrameProfiler &profiler);
+
+    virtual void draw(tsl::gfx::Renderer *renderer) override;
+};
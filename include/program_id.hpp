@@ -0,0 +1,96 @@
+#pragma once
+
+#include <switch.h>
+
+#include <array>
+#include <string_view>
+
+namespace impl {
+
+    /* Nibble value of every character, 0x10 for anything that isn't a hex digit. */
+    constexpr std::array<u8, 256> HexDigitTable = [] {
+        std::array<u8, 256> table{};
+        for (u32 c = 0; c < 256; c++) {
+            if (c >= '0' && c <= '9')
+                table[c] = c - '0';
+            else if (c >= 'a' && c <= 'f')
+                table[c] = c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F')
+                table[c] = c - 'A' + 10;
+            else
+                table[c] = 0x10;
+        }
+        return table;
+    }();
+
+}
+
+constexpr size_t ProgramIdLength = 16;
+
+/*
+ * Parses a program id written as exactly 16 hex digits, without prefix or
+ * whitespace. The digits are folded without early exits, an invalid one only
+ * sets a bit that is checked once at the end.
+ */
+constexpr bool parseProgramId(std::string_view str, u64 &programId) {
+    if (str.size() != ProgramIdLength)
+        return false;
+
+    u64 value = 0;
+    u32 invalid = 0;
+    for (size_t i = 0; i < ProgramIdLength; i++) {
+        u32 nibble = impl::HexDigitTable[static_cast<u8>(str[i])];
+        invalid |= nibble;
+        value = (value << 4) | (nibble & 0xF);
+    }
+    if (invalid & 0x10)
+        return false;
+
+    programId = value;
+    return true;
+}
+
+/* Writes the 16 upper case hex digits of a program id to out, without a terminator. */
+constexpr void formatProgramId(u64 programId, char *out) {
+    constexpr char digits[] = "0123456789ABCDEF";
+    for (size_t i = 0; i < ProgramIdLength; i++)
+        out[i] = digits[(programId >> ((ProgramIdLength - 1 - i) * 4)) & 0xF];
+}
+
+namespace impl {
+
+    constexpr bool formatsTo(u64 programId, std::string_view expected) {
+        char out[ProgramIdLength] = {};
+        formatProgramId(programId, out);
+        return std::string_view(out, ProgramIdLength) == expected;
+    }
+
+    static_assert(formatsTo(0x0100000000000352ULL, "0100000000000352"));
+    static_assert(formatsTo(0x420000000007E51AULL, "420000000007E51A"));
+    static_assert(formatsTo(0, "0000000000000000"));
+
+    constexpr bool parsesTo(std::string_view str, u64 expected) {
+        u64 value = 0;
+        return parseProgramId(str, value) && value == expected;
+    }
+
+    constexpr bool rejects(std::string_view str) {
+        u64 value = 0;
+        return !parseProgramId(str, value);
+    }
+
+    static_assert(parsesTo("0100000000000352", 0x0100000000000352ULL));
+    static_assert(parsesTo("420000000007E51A", 0x420000000007E51AULL));
+    static_assert(parsesTo("420000000007e51a", 0x420000000007E51AULL));
+    static_assert(parsesTo("FFFFFFFFFFFFFFFF", 0xFFFFFFFFFFFFFFFFULL));
+    static_assert(parsesTo("0000000000000000", 0));
+    static_assert(rejects(""));
+    static_assert(rejects("010000000000035"));
+    static_assert(rejects("01000000000003520"));
+    static_assert(rejects("0x00000000000352"));
+    static_assert(rejects("01000Z00000G0000"));
+    static_assert(rejects(" 100000000000352"));
+    static_assert(rejects("010000000000035g"));
+    static_assert(rejects(std::string_view("0100000000\0000352", 16)));
+
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <switch.h>
+
+#include <algorithm>
+
+/*
+ * Tracks which part of a long list is bound to a small pool of recycled rows.
+ * Entry i always lives in slot i % poolSize(), so moving the window by one
+ * entry only requires rebinding the single row that scrolled into the margin.
+ */
+class RowWindow {
+  private:
+    u32 m_count = 0;
+    u32 m_visible;
+    u32 m_margin;
+    u32 m_first = 0;
+    u32 m_cursor = 0;
+
+  public:
+    RowWindow(u32 visible, u32 margin) : m_visible(std::max<u32>(visible, 1)), m_margin(margin) {}
+
+    u32 count() const { return this->m_count; }
+    u32 first() const { return this->m_first; }
+    u32 cursor() const { return this->m_cursor; }
+    u32 poolSize() const { return this->m_visible + 2 * this->m_margin; }
+    u32 visibleCount() const { return std::min(this->m_visible, this->m_count - this->m_first); }
+    u32 visibleRows() const { return std::min(this->m_visible, this->m_count); }
+
+    /* Range of entries that currently have a row bound to them. */
+    u32 boundBegin() const { return this->m_first > this->m_margin ? this->m_first - this->m_margin : 0; }
+    u32 boundEnd() const { return std::min(this->m_count, this->m_first + this->m_visible + this->m_margin); }
+    bool isBound(u32 index) const { return index >= this->boundBegin() && index < this->boundEnd(); }
+
+    u32 slotOf(u32 index) const { return index % this->poolSize(); }
+
+    void setCount(u32 count) {
+        this->m_count = count;
+        this->m_cursor = count > 0 ? std::min(this->m_cursor, count - 1) : 0;
+        this->m_first = std::min(this->m_first, count > this->m_visible ? count - this->m_visible : 0);
+        this->m_first = std::min(this->m_first, this->m_cursor);
+    }
+
+    /* Moves the cursor and scrolls just enough to keep it visible. Returns whether the window moved. */
+    bool moveTo(u32 index) {
+        if (this->m_count == 0)
+            return false;
+
+        this->m_cursor = std::min(index, this->m_count - 1);
+
+        u32 first = this->m_first;
+        if (this->m_cursor < first)
+            first = this->m_cursor;
+        else if (this->m_cursor >= first + this->m_visible)
+            first = this->m_cursor - this->m_visible + 1;
+
+        bool moved = first != this->m_first;
+        this->m_first = first;
+        return moved;
+    }
+};
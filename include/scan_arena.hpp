@@ -0,0 +1,71 @@
+#pragma once
+
+#include <switch.h>
+
+#include <cstddef>
+#include <string_view>
+
+/*
+ * Bump allocator for everything a scan produces. Memory is handed out from
+ * blocks of a few KiB, allocations over half a block get a block of their
+ * own. It's only ever returned all at once, either by rewinding to a marker
+ * or by releasing the whole arena when the scan is discarded. Blocks are kept
+ * small since a scan's peak is what has to fit next to the overlay.
+ */
+class ScanArena {
+  public:
+    static constexpr size_t DefaultBlockSize = 0x1000;
+
+    struct Marker {
+        void *block;
+        size_t used;
+        void *large;
+    };
+
+  private:
+    struct Block {
+        Block *next;
+        size_t size;
+        size_t used;
+    };
+
+    Block *m_head = nullptr;
+    /* Allocations too large for a regular block get their own, kept apart so the current block stays in use. */
+    Block *m_large = nullptr;
+    size_t m_blockSize;
+    size_t m_reserved = 0;
+    u32 m_blocks = 0;
+
+  public:
+    explicit ScanArena(size_t blockSize = DefaultBlockSize) : m_blockSize(blockSize) {}
+    ScanArena(const ScanArena &) = delete;
+    ScanArena(ScanArena &&other);
+    ScanArena &operator=(const ScanArena &) = delete;
+    ScanArena &operator=(ScanArena &&other);
+    ~ScanArena();
+
+    /* Returns nullptr if the heap is exhausted. */
+    void *allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    template <typename T>
+    T *allocateArray(size_t count) {
+        return static_cast<T *>(this->allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    /* Gives back the tail of ptr, which has to be the most recent allocation. */
+    void shrink(void *ptr, size_t size);
+
+    /* Copies str into the arena, returns an empty view if that fails. */
+    std::string_view copy(std::string_view str);
+
+    Marker mark() const;
+    /* Frees everything allocated after marker was taken. */
+    void rewind(const Marker &marker);
+    void release();
+
+    /* Moves all of other's blocks into this arena, other is left empty. */
+    void adopt(ScanArena &other);
+
+    size_t reservedBytes() const { return this->m_reserved; }
+    u32 blockCount() const { return this->m_blocks; }
+};
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "content_root.hpp"
+#include "scan_arena.hpp"
+
+#include <span>
+#include <string_view>
+
+constexpr const char *const ScanIndexPath = "/config/ovlSysmodules/scan_index.bin";
+
+/* Where a module's name and flags were read from. */
+enum class ModuleSource : u8 {
+    None,
+    Toolbox,
+    ExefsNsp,
+    ExefsNpdm,
+};
+
+/*
+ * Cache of what the previous scan found in each title directory, stored on the
+ * SD card. An entry is only trusted while the modification time of the file it
+ * was read from hasn't changed, which is one metadata query instead of opening
+ * and reading the file again.
+ *
+ * File layout, little endian: Header, Entry[entryCount] sorted by root and program id,
+ * then namesSize bytes of names the entries point into, each name followed by
+ * the entry's dependencies as unaligned program ids.
+ */
+class ScanIndex {
+  public:
+    struct Entry {
+        u64 programId;
+        u64 modified;
+        u32 nameOffset;
+        u8 nameLength;
+        u8 root;
+        ModuleSource source;
+        u8 flags;
+        u8 dependencyCount;
+        u8 reserved[7];
+    };
+    static_assert(sizeof(Entry) == 32);
+
+    /* Longer names aren't worth the space, those modules are just read again every time. */
+    static constexpr size_t MaxNameLength = 0xFF;
+
+    /* Collects the entries of a scan and writes them out as a new index. */
+    class Writer {
+      private:
+        struct Record {
+            Record *next;
+            u64 programId;
+            u64 modified;
+            std::string_view name;
+            std::span<const u64> dependencies;
+            u8 root;
+            ModuleSource source;
+            u8 flags;
+        };
+
+        ScanArena m_records;
+        Record *m_head = nullptr;
+        u32 m_count = 0;
+        u32 m_namesSize = 0;
+
+        /* The file contents, allocated from arena. */
+        u8 *layout(ScanArena &arena, size_t &size) const;
+
+      public:
+        /* name and dependencies only have to stay valid until save() or build(). Returns false if out of memory. */
+        bool add(u64 programId, u8 root, u64 modified, ModuleSource source, u8 flags, std::string_view name, std::span<const u64> dependencies = {});
+        Result save(FsFileSystem *fs, const char *path);
+        /* Makes index the one save() would write, without the round trip through the SD card. */
+        bool build(ScanArena &arena, ScanIndex &index) const;
+    };
+
+  private:
+    struct Header {
+        u32 magic;
+        u32 version;
+        u32 entryCount;
+        u32 namesSize;
+    };
+    static_assert(sizeof(Header) == 16);
+
+    static constexpr u32 Magic = 0x58444953;
+    static constexpr u32 Version = 3;
+
+    const Entry *m_entries = nullptr;
+    const char *m_names = nullptr;
+    u32 m_count = 0;
+
+  public:
+    /* Reads the index into arena. If it's missing or doesn't validate the index stays empty. */
+    Result load(FsFileSystem *fs, const char *path, ScanArena &arena);
+
+    u32 size() const { return this->m_count; }
+    const Entry *find(u8 root, u64 programId) const;
+    /* Points into the loaded file, so it lives as long as the arena it was loaded into. */
+    std::string_view name(const Entry &entry) const {
+        return std::string_view(this->m_names + entry.nameOffset, entry.nameLength);
+    }
+    /* Copies the entry's dependencies to out, which needs room for entry.dependencyCount. */
+    void dependencies(const Entry &entry, u64 *out) const;
+};
+
+/* Modification time of a file as the index records it, 0 if the filesystem doesn't have one. */
+Result getModificationTime(FsFileSystem *fs, const char *path, u64 &modified);
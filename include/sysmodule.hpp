@@ -0,0 +1,24 @@
+#pragma once
+
+#include "scan_arena.hpp"
+
+#include <switch.h>
+
+#include <string_view>
+
+/* Let's not allow Tesla to be killed with this. */
+constexpr u64 TeslaProgramId = 0x420000000007E51AULL;
+
+/* These helpers don't depend on Tesla so they can be shared with the host tools. */
+bool fileExists(FsFileSystem *fs, const char *path);
+/* Reads a whole file into a buffer allocated from arena. */
+Result readFile(FsFileSystem *fs, const char *path, ScanArena &arena, std::string_view &data);
+bool isProgramRunning(u64 programId);
+/* Memory the process of a running program uses, through Atmosphère's pm extension. Fails if it isn't running. */
+Result getProgramMemoryUsage(u64 programId, u64 &usedBytes);
+/* Size and usage of the system memory pool, the one sysmodules are allocated from. */
+Result getSystemPoolUsage(u64 &size, u64 &usedBytes);
+
+Result CopyFile(FsFileSystem *fs, const char *srcPath, const char *destPath);
+/* Appends to path, creating it. A file that would grow past maxSize is started over, so it never needs trimming. */
+Result AppendFile(FsFileSystem *fs, const char *path, const void *data, size_t size, s64 maxSize);
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <switch.h>
+
+#include <string_view>
+
+/* Dependencies a toolbox.json may list, more make it invalid. */
+constexpr u32 MaxDependencies = 8;
+
+struct ToolboxInfo {
+    u64 programId;
+    /* Still JSON escaped, points into the parsed buffer. */
+    std::string_view rawName;
+    bool needReboot;
+    /* Program ids that have to run before this module starts, optional. */
+    u64 dependencies[MaxDependencies];
+    u8 dependencyCount;
+};
+
+/*
+ * Validates a toolbox.json without building a DOM or allocating and extracts
+ * the fields the overlay uses. tid, name and requires_reboot are required and
+ * tid has to be a 16 digit hex program id. dependencies is optional, an array
+ * of program ids like tid.
+ */
+bool parseToolbox(std::string_view data, ToolboxInfo &info);
+
+/* Decodes a raw JSON string body into out, which needs room for raw.size() bytes. Returns the decoded length. */
+size_t unescapeJsonString(std::string_view raw, char *out);
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "row_window.hpp"
+
+#include <functional>
+#include <vector>
+#include <tesla.hpp>
+
+/*
+ * List of ListItems that only allocates rows for the visible window plus a small
+ * margin. Rows are recycled while scrolling, the entries themselves live in
+ * whatever array the bind callback reads from.
+ */
+class VirtualList : public tsl::elm::Element {
+  public:
+    /* recycled is set when the row now shows a different entry than before. */
+    using BindCallback = std::function<void(tsl::elm::ListItem *row, u32 index, bool recycled)>;
+    using ClickCallback = std::function<bool(u32 index, u64 keys)>;
+
+    static constexpr u32 RowHeight = tsl::style::ListItemDefaultHeight;
+
+    VirtualList(u32 count, u32 visibleRows, u32 marginRows, BindCallback bind, ClickCallback click);
+    virtual ~VirtualList();
+
+    u32 getCount() const { return this->m_window.count(); }
+    u32 getCursor() const { return this->m_window.cursor(); }
+    u16 getListHeight() const { return this->m_window.visibleRows() * RowHeight; }
+    /* Entries [getBoundBegin(), getBoundEnd()) have a row bound to them. */
+    u32 getBoundBegin() const { return this->m_window.boundBegin(); }
+    u32 getBoundEnd() const { return this->m_window.boundEnd(); }
+
+    void setCount(u32 count);
+    /* Same as setCount, then scrolls so entry cursor is the one focus returns to. */
+    void setCount(u32 count, u32 cursor);
+    bool ownsRow(tsl::elm::Element *element) const;
+    /* Calls the bind callback for every bound row without recycling it. */
+    void refresh();
+
+    virtual void draw(tsl::gfx::Renderer *renderer) override;
+    virtual void layout(u16 parentX, u16 parentY, u16 parentWidth, u16 parentHeight) override;
+    virtual tsl::elm::Element *requestFocus(tsl::elm::Element *oldFocus, tsl::FocusDirection direction) override;
+    virtual bool onTouch(tsl::elm::TouchEvent event, s32 currX, s32 currY, s32 prevX, s32 prevY, s32 initialX, s32 initialY) override;
+
+  private:
+    static constexpr u32 UnboundSlot = ~0u;
+
+    RowWindow m_window;
+    std::vector<tsl::elm::ListItem *> m_rows;
+    std::vector<u32> m_slotIndex;
+    BindCallback m_bind;
+    ClickCallback m_click;
+
+    tsl::elm::ListItem *rowAt(u32 index) const;
+    void scrollTo(u32 index);
+    void bindWindow();
+    void layoutRows();
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <switch.h>
+
+#include <atomic>
+
+/*
+ * Runs a task for every index of [0, count) on a few threads. Each worker
+ * starts out with an even share of the indices and takes them from the front
+ * of its share. A worker that runs out steals the back half of another one's
+ * share, so a few slow items (a large file, a slow card) don't leave the other
+ * workers idle. The calling thread is worker 0.
+ */
+class WorkPool {
+  public:
+    static constexpr u32 MaxWorkers = 4;
+    static constexpr size_t StackSize = 0x8000;
+    static constexpr int ThreadPriority = 0x2C;
+
+    /* worker is in [0, MaxWorkers), tasks on the same worker never run concurrently. */
+    using Task = void (*)(void *context, u32 worker, u32 index);
+
+  private:
+    /* [begin, end) of the indices left to a worker, packed so both change in one exchange. */
+    struct alignas(64) Share {
+        std::atomic<u64> bounds;
+    };
+
+    struct Worker {
+        WorkPool *pool;
+        u32 index;
+        Thread thread;
+    };
+
+    Share m_shares[MaxWorkers];
+    u32 m_workers;
+    u32 m_active = 0;
+    Task m_task = nullptr;
+    void *m_context = nullptr;
+
+    bool next(u32 worker, u32 &index);
+    bool steal(u32 worker);
+    void work(u32 worker);
+    static void threadEntry(void *arg);
+
+  public:
+    explicit WorkPool(u32 workers);
+    WorkPool(const WorkPool &) = delete;
+    WorkPool &operator=(const WorkPool &) = delete;
+
+    /*
+     * Blocks until task ran for every index. Workers whose thread can't be
+     * created leave their share to the others to steal. Returns the number of
+     * workers that took part.
+     */
+    u32 run(u32 count, Task task, void *context);
+
+    template <typename F>
+    u32 run(u32 count, F &function) {
+        return this->run(count, [](void *context, u32 worker, u32 index) {
+            (*static_cast<F *>(context))(worker, index);
+        }, &function);
+    }
+};
@@ -1,7 +1,9 @@
 #include "dir_iterator.hpp"
 
+#include "ipc_stats.hpp"
+
 FsDirIterator::FsDirIterator(FsDir dir) : m_dir(dir) {
-    if (R_FAILED(fsDirRead(&this->m_dir, &this->count, 1, &this->entry)))
+    if (R_FAILED(ipcCall(IpcCall::FsDirRead, fsDirRead, &this->m_dir, &this->count, 1, &this->entry)))
         this->count = 0;
 }
 
@@ -14,7 +16,7 @@ const FsDirectoryEntry *FsDirIterator::operator->() const {
 }
 
 FsDirIterator &FsDirIterator::operator++() {
-    if (R_FAILED(fsDirRead(&this->m_dir, &this->count, 1, &this->entry)))
+    if (R_FAILED(ipcCall(IpcCall::FsDirRead, fsDirRead, &this->m_dir, &this->count, 1, &this->entry)))
         this->count = 0;
     return *this;
 }
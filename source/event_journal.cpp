@@ -0,0 +1,52 @@
+#include "event_journal.hpp"
+
+#include "scan_arena.hpp"
+
+#include <cstdio>
+
+namespace {
+
+    constexpr const char *const actionNames[u32(JournalAction::Count)] = {
+        [u32(JournalAction::Start)] = "start",
+        [u32(JournalAction::Stop)] = "stop",
+        [u32(JournalAction::CreateFlag)] = "create_flag",
+        [u32(JournalAction::DeleteFlag)] = "delete_flag",
+        [u32(JournalAction::ExitedEarly)] = "exited_early",
+        [u32(JournalAction::NotVisible)] = "not_visible",
+        [u32(JournalAction::SelectBootDat)] = "select_boot_dat",
+    };
+
+    /* "123456.789 select_boot_dat 0100000000001000 0x1A3C02 4294967295\n" fits with room to spare. */
+    constexpr size_t MaxLineLength = 80;
+
+}
+
+const char *journalActionName(JournalAction action) {
+    return action < JournalAction::Count ? actionNames[u32(action)] : "unknown";
+}
+
+Result EventJournal::flush(Backend &backend, const char *path) {
+    const u32 count = std::min<u64>(this->unflushed(), Capacity);
+    if (count == 0)
+        return 0;
+
+    ScanArena scratch;
+    char *text = static_cast<char *>(scratch.allocate(count * MaxLineLength, 1));
+    if (text == nullptr)
+        return MAKERESULT(Module_Libnx, LibnxError_OutOfMemory);
+
+    /* Oldest first, like a log reads. */
+    size_t length = 0;
+    for (u32 age = count; age-- > 0;) {
+        const Event &event = this->event(age);
+        const u64 ms = armTicksToNs(event.tick) / 1'000'000;
+        const int written = std::snprintf(text + length, MaxLineLength, "%lu.%03lu %s %016lX 0x%X %lu\n", ms / 1000, ms % 1000, journalActionName(event.action),
+                                          event.programId, event.result, armTicksToNs(event.durationTicks) / 1000);
+        length += std::min<size_t>(written, MaxLineLength - 1);
+    }
+
+    Result rc = backend.appendFile(path, std::string_view(text, length), MaxJournalFileSize);
+    if (R_SUCCEEDED(rc))
+        this->m_flushed = this->m_recorded;
+    return rc;
+}
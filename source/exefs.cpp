@@ -0,0 +1,122 @@
+#include "exefs.hpp"
+
+#include "ipc_stats.hpp"
+
+#include <cstring>
+#include <string_view>
+
+namespace {
+
+    constexpr u32 MetaMagic = 0x4154454D;
+    constexpr u32 Pfs0Magic = 0x30534650;
+
+    /* Only the part of the META header up to and including the name. */
+    struct NpdmHeader {
+        u32 magic;
+        u8 reserved[0x1C];
+        char name[NpdmNameLength];
+    };
+    static_assert(sizeof(NpdmHeader) == 0x30);
+
+    struct Pfs0Header {
+        u32 magic;
+        u32 fileCount;
+        u32 stringTableSize;
+        u32 reserved;
+    };
+    static_assert(sizeof(Pfs0Header) == 0x10);
+
+    struct Pfs0Entry {
+        u64 offset;
+        u64 size;
+        u32 nameOffset;
+        u32 reserved;
+    };
+    static_assert(sizeof(Pfs0Entry) == 0x18);
+
+    /* Read at once from the start of an exefs.nsp, room for the header and the tables of a dozen files. */
+    constexpr size_t Pfs0MetaReadSize = 0x200;
+
+    constexpr Result ResultInvalidExefs = MAKERESULT(Module_Libnx, LibnxError_BadInput);
+    constexpr Result ResultNoNpdm = MAKERESULT(Module_Libnx, LibnxError_NotFound);
+
+    size_t boundedLength(const char *str, size_t maxLength) {
+        const void *end = std::memchr(str, '\0', maxLength);
+        return end != nullptr ? static_cast<const char *>(end) - str : maxLength;
+    }
+
+    Result readAt(FsFile *file, s64 offset, void *buffer, size_t size, u64 &bytesRead) {
+        return ipcCall(IpcCall::FsFileRead, fsFileRead, file, offset, buffer, size, FsReadOption_None, &bytesRead);
+    }
+
+    Result readNpdmHeader(FsFile *file, s64 offset, char *name, size_t &length) {
+        NpdmHeader header;
+        u64 bytesRead = 0;
+        if (Result rc = readAt(file, offset, &header, sizeof(header), bytesRead); R_FAILED(rc))
+            return rc;
+        if (bytesRead != sizeof(header) || header.magic != MetaMagic)
+            return ResultInvalidExefs;
+
+        length = boundedLength(header.name, NpdmNameLength);
+        if (length == 0)
+            return ResultInvalidExefs;
+        std::memcpy(name, header.name, length);
+        return 0;
+    }
+
+    Result readNspNpdm(FsFile *file, char *name, size_t &length) {
+        alignas(Pfs0Entry) u8 buffer[Pfs0MetaReadSize];
+        u64 bytesRead = 0;
+        if (Result rc = readAt(file, 0, buffer, sizeof(buffer), bytesRead); R_FAILED(rc))
+            return rc;
+
+        Pfs0Header header;
+        if (bytesRead < sizeof(header))
+            return ResultInvalidExefs;
+        std::memcpy(&header, buffer, sizeof(header));
+
+        /* Anything whose tables don't fit the first read isn't an exefs we'd expect. */
+        const u64 tablesSize = u64(header.fileCount) * sizeof(Pfs0Entry) + header.stringTableSize;
+        if (header.magic != Pfs0Magic || sizeof(header) + tablesSize > bytesRead)
+            return ResultInvalidExefs;
+
+        const auto *entries = reinterpret_cast<const Pfs0Entry *>(buffer + sizeof(header));
+        const char *strings = reinterpret_cast<const char *>(entries + header.fileCount);
+        for (u32 i = 0; i < header.fileCount; i++) {
+            const Pfs0Entry &entry = entries[i];
+            if (entry.nameOffset >= header.stringTableSize)
+                return ResultInvalidExefs;
+
+            std::string_view fileName(strings + entry.nameOffset, boundedLength(strings + entry.nameOffset, header.stringTableSize - entry.nameOffset));
+            if (fileName != "main.npdm")
+                continue;
+            if (entry.size < sizeof(NpdmHeader))
+                return ResultInvalidExefs;
+            return readNpdmHeader(file, sizeof(header) + tablesSize + entry.offset, name, length);
+        }
+        return ResultNoNpdm;
+    }
+
+}
+
+Result readNpdmName(FsFileSystem *fs, const char *path, char *name, size_t &length) {
+    FsFile file;
+    Result rc = ipcCall(IpcCall::FsOpenFile, fsFsOpenFile, fs, path, FsOpenMode_Read, &file);
+    if (R_FAILED(rc))
+        return rc;
+
+    rc = readNpdmHeader(&file, 0, name, length);
+    ipcCall(IpcCall::FsFileClose, fsFileClose, &file);
+    return rc;
+}
+
+Result readNspNpdmName(FsFileSystem *fs, const char *path, char *name, size_t &length) {
+    FsFile file;
+    Result rc = ipcCall(IpcCall::FsOpenFile, fsFsOpenFile, fs, path, FsOpenMode_Read, &file);
+    if (R_FAILED(rc))
+        return rc;
+
+    rc = readNspNpdm(&file, name, length);
+    ipcCall(IpcCall::FsFileClose, fsFileClose, &file);
+    return rc;
+}
@@ -0,0 +1,43 @@
+#include "frame_profiler.hpp"
+
+#include <algorithm>
+
+void FrameProfiler::setEnabled(bool enabled) {
+    this->m_enabled = enabled;
+    this->m_next = this->m_count = this->m_pendingUpdateTicks = 0;
+}
+
+void FrameProfiler::recordDraw(u64 ticks) {
+    this->m_updateTicks[this->m_next] = this->m_pendingUpdateTicks;
+    this->m_drawTicks[this->m_next] = std::min<u64>(ticks, ~0u);
+    this->m_next = (this->m_next + 1) % Frames;
+    this->m_count = std::min(this->m_count + 1, Frames);
+    this->m_pendingUpdateTicks = 0;
+}
+
+u64 FrameProfiler::frameNs(u32 age) const {
+    const u32 frame = (this->m_next + Frames - 1 - age) % Frames;
+    return armTicksToNs(u64(this->m_updateTicks[frame]) + this->m_drawTicks[frame]);
+}
+
+FrameProfiler::Summary FrameProfiler::summarize() const {
+    Summary summary = { .frames = this->m_count };
+    if (this->m_count == 0)
+        return summary;
+
+    const u32 last = (this->m_next + Frames - 1) % Frames;
+    summary.lastUpdateNs = armTicksToNs(this->m_updateTicks[last]);
+    summary.lastDrawNs = armTicksToNs(this->m_drawTicks[last]);
+
+    /* A copy of at most 128 totals, partially sorted twice, is cheap enough to redo on every frame. */
+    u64 totals[Frames];
+    for (u32 i = 0; i < this->m_count; i++)
+        totals[i] = u64(this->m_updateTicks[i]) + this->m_drawTicks[i];
+    const u32 p50 = (this->m_count - 1) / 2, p99 = (this->m_count - 1) * 99 / 100;
+    std::nth_element(totals, totals + p99, totals + this->m_count);
+    summary.p99Ns = armTicksToNs(totals[p99]);
+    summary.maxNs = armTicksToNs(*std::max_element(totals + p99, totals + this->m_count));
+    std::nth_element(totals, totals + p50, totals + p99);
+    summary.p50Ns = armTicksToNs(totals[p50]);
+    return summary;
+}
@@ -0,0 +1,91 @@
+#include "gui_heap.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+static constexpr const char *const phaseNames[u32(HeapPhase::Count)] = {
+    [u32(HeapPhase::Scan)] = "Scan",
+    [u32(HeapPhase::CreateUI)] = "Create UI",
+};
+
+static void formatBytes(char *buffer, size_t size, u64 bytes) {
+    if (bytes >= 1024 * 1024)
+        std::snprintf(buffer, size, "%.2f MiB", bytes / (1024.0 * 1024.0));
+    else if (bytes >= 1024)
+        std::snprintf(buffer, size, "%.1f KiB", bytes / 1024.0);
+    else
+        std::snprintf(buffer, size, "%lu B", bytes);
+}
+
+GuiHeap::GuiHeap() {
+    getHeapStats(this->m_stats);
+}
+
+tsl::elm::Element *GuiHeap::createUI() {
+    tsl::elm::OverlayFrame *rootFrame = new tsl::elm::OverlayFrame("Heap usage", VERSION);
+    tsl::elm::List *heapList = new tsl::elm::List();
+
+    heapList->addItem(new tsl::elm::CategoryHeader("Usage  |    Back", true));
+    heapList->addItem(new tsl::elm::CustomDrawer([this](tsl::gfx::Renderer *renderer, s32 x, s32 y, s32 w, s32 h) {
+        if (!this->m_stats.instrumented()) {
+            renderer->drawString("  Allocator isn't instrumented in this build.", false, x + 5, y + 20, 15, renderer->a(tsl::style::color::ColorDescription));
+            return;
+        }
+
+        char line[96], current[24], peak[24];
+        formatBytes(current, sizeof(current), this->m_stats.currentBytes);
+        formatBytes(peak, sizeof(peak), this->m_stats.peakBytes);
+        std::snprintf(line, sizeof(line), "Now %s  |  Peak %s", current, peak);
+        renderer->drawString(line, false, x + 5, y + 20, 18, renderer->a(tsl::style::color::ColorText));
+        std::snprintf(line, sizeof(line), "%lu allocations, %lu live", this->m_stats.allocations, this->m_stats.allocations - this->m_stats.frees);
+        renderer->drawString(line, false, x + 5, y + 45, 15, renderer->a(tsl::style::color::ColorDescription));
+
+        /* Checkpoints are fixed once taken, their peak is the highest usage during that phase. */
+        s32 lineY = y + 75;
+        for (u32 phase = 0; phase < u32(HeapPhase::Count); phase++, lineY += 22) {
+            const HeapCheckpoint &checkpoint = getHeapPhase(HeapPhase(phase));
+            if (!checkpoint.taken) {
+                std::snprintf(line, sizeof(line), "%s: -", phaseNames[phase]);
+            } else {
+                formatBytes(current, sizeof(current), checkpoint.currentBytes);
+                formatBytes(peak, sizeof(peak), checkpoint.peakBytes);
+                std::snprintf(line, sizeof(line), "%s: %s, peak %s", phaseNames[phase], current, peak);
+            }
+            renderer->drawString(line, false, x + 5, lineY, 15, renderer->a(tsl::style::color::ColorText));
+        }
+    }), 130);
+
+    heapList->addItem(new tsl::elm::CategoryHeader("Allocation sizes", true));
+    heapList->addItem(new tsl::elm::CustomDrawer([this](tsl::gfx::Renderer *renderer, s32 x, s32 y, s32 w, s32 h) {
+        u64 largest = 1;
+        for (u64 count : this->m_stats.histogram)
+            largest = std::max(largest, count);
+
+        /* One bar per power of two size class, scaled to the most common one. */
+        constexpr s32 RowHeight = 22, LabelWidth = 90, CountWidth = 70;
+        const s32 barWidth = w - LabelWidth - CountWidth - 10;
+        char label[24], count[24];
+        for (u32 bucket = 0; bucket < HeapStats::Buckets; bucket++) {
+            s32 rowY = y + bucket * RowHeight;
+            formatBytes(label, sizeof(label), HeapStats::bucketFloor(bucket));
+            std::snprintf(count, sizeof(count), "%lu", this->m_stats.histogram[bucket]);
+            if (bucket == HeapStats::Buckets - 1)
+                std::strcat(label, "+");
+            renderer->drawString(label, false, x, rowY + 16, 13, renderer->a(tsl::style::color::ColorDescription));
+            renderer->drawRect(x + LabelWidth, rowY + 5, barWidth * this->m_stats.histogram[bucket] / largest, RowHeight - 8, renderer->a(tsl::style::color::ColorHighlight));
+            renderer->drawString(count, false, x + w - CountWidth, rowY + 16, 13, renderer->a(tsl::style::color::ColorText));
+        }
+    }), HeapStats::Buckets * 22 + 10);
+
+    rootFrame->setContent(heapList);
+    return rootFrame;
+}
+
+void GuiHeap::update() {
+    static u32 counter = 0;
+
+    if (counter++ % 10 != 0)
+        return;
+
+    getHeapStats(this->m_stats);
+}
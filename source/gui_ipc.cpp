@@ -0,0 +1,64 @@
+#include "gui_ipc.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+static constexpr s32 CallRowHeight = 62;
+
+GuiIpc::GuiIpc() {
+    this->refresh();
+}
+
+void GuiIpc::refresh() {
+    for (u32 call = 0; call < u32(IpcCall::Count); call++)
+        getIpcStats(IpcCall(call), this->m_stats[call]);
+}
+
+tsl::elm::Element *GuiIpc::createUI() {
+    tsl::elm::OverlayFrame *rootFrame = new tsl::elm::OverlayFrame("Service calls", VERSION);
+    tsl::elm::List *callList = new tsl::elm::List();
+
+    callList->addItem(new tsl::elm::CategoryHeader("Since the overlay started  |    Back", true));
+    callList->addItem(new tsl::elm::CustomDrawer([](tsl::gfx::Renderer *renderer, s32 x, s32 y, s32 w, s32 h) {
+        renderer->drawString("  Bars are call latencies, 1 us to 16 ms doubling.", false, x + 5, y + 20, 15, renderer->a(tsl::style::color::ColorDescription));
+    }), 30);
+
+    /* Rows for every kind of call, the ones never made are skipped when drawing. */
+    callList->addItem(new tsl::elm::CustomDrawer([this](tsl::gfx::Renderer *renderer, s32 x, s32 y, s32 w, s32 h) {
+        constexpr s32 BarGap = 2;
+        const s32 barWidth = (w - 10) / s32(IpcCallStats::Buckets) - BarGap;
+        char line[96];
+        s32 rowY = y;
+        for (u32 call = 0; call < u32(IpcCall::Count); call++) {
+            const IpcCallStats &stats = this->m_stats[call];
+            if (stats.calls == 0)
+                continue;
+
+            std::snprintf(line, sizeof(line), "%s", ipcCallName(IpcCall(call)));
+            renderer->drawString(line, false, x + 5, rowY + 16, 15, renderer->a(tsl::style::color::ColorText));
+            std::snprintf(line, sizeof(line), "%lu calls, %lu failed  |  avg %lu us, max %lu us", stats.calls, stats.failures, stats.totalNs / stats.calls / 1000,
+                          stats.maxNs / 1000);
+            renderer->drawString(line, false, x + 5, rowY + 34, 13, renderer->a(tsl::style::color::ColorDescription));
+
+            const u64 largest = std::max<u64>(*std::max_element(stats.histogram, stats.histogram + IpcCallStats::Buckets), 1);
+            for (u32 bucket = 0; bucket < IpcCallStats::Buckets; bucket++) {
+                const s32 height = 18 * stats.histogram[bucket] / largest;
+                renderer->drawRect(x + 5 + bucket * (barWidth + BarGap), rowY + 58 - height, barWidth, std::max<s32>(height, 1),
+                                   renderer->a(tsl::style::color::ColorHighlight));
+            }
+            rowY += CallRowHeight;
+        }
+    }), u32(IpcCall::Count) * CallRowHeight + 10);
+
+    rootFrame->setContent(callList);
+    return rootFrame;
+}
+
+void GuiIpc::update() {
+    static u32 counter = 0;
+
+    if (counter++ % 10 != 0)
+        return;
+
+    this->refresh();
+}
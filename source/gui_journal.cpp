@@ -0,0 +1,64 @@
+#include "gui_journal.hpp"
+
+#include <cstdio>
+
+static constexpr u32 JournalVisibleRows = 8;
+static constexpr u32 JournalMarginRows = 2;
+
+GuiJournal::GuiJournal(ModuleEngine &engine) : m_engine(engine) {}
+
+tsl::elm::Element *GuiJournal::createUI() {
+    tsl::elm::OverlayFrame *rootFrame = new tsl::elm::OverlayFrame("Event journal", VERSION);
+    tsl::elm::List *journalList = new tsl::elm::List();
+
+    journalList->addItem(new tsl::elm::CategoryHeader("Newest first  |    Back", true));
+    journalList->addItem(new tsl::elm::CustomDrawer([](tsl::gfx::Renderer *renderer, s32 x, s32 y, s32 w, s32 h) {
+        renderer->drawString("  Written to the SD card when the overlay exits.", false, x + 5, y + 20, 15, renderer->a(tsl::style::color::ColorDescription));
+    }), 30);
+
+    /* "12:34.567  stop" on the left, "sys-ftpd  |  0x0  |  3 ms" on the right. */
+    auto bind = [this](tsl::elm::ListItem *row, u32 index, bool recycled) {
+        const EventJournal::Event &event = this->m_engine.journal().event(index);
+        const u64 ms = armTicksToNs(event.tick) / 1'000'000;
+        char text[48], value[96];
+        std::snprintf(text, sizeof(text), "%lu:%02lu.%03lu  %s", ms / 60'000, ms / 1000 % 60, ms % 1000, journalActionName(event.action));
+        row->setText(text);
+
+        const ModuleTable &modules = this->m_engine.modules();
+        const u32 module = this->m_engine.find(event.programId);
+        char name[32];
+        if (module != modules.size())
+            std::snprintf(name, sizeof(name), "%.*s", int(modules.name(module).size()), modules.name(module).data());
+        else if (event.programId != 0)
+            std::snprintf(name, sizeof(name), "%016lX", event.programId);
+        else
+            name[0] = '\0';
+        std::snprintf(value, sizeof(value), "%s  |  0x%X  |  %lu ms", name, event.result, armTicksToNs(event.durationTicks) / 1'000'000);
+        row->setValue(value);
+    };
+    auto click = [](u32 index, u64 keys) -> bool {
+        return false;
+    };
+
+    this->m_shownSize = this->m_engine.journal().size();
+    if (this->m_shownSize == 0) {
+        journalList->addItem(new tsl::elm::CustomDrawer([](tsl::gfx::Renderer *renderer, s32 x, s32 y, s32 w, s32 h) {
+            renderer->drawString("Nothing was started, stopped or flagged yet.", false, x + 5, y + 20, 15, renderer->a(tsl::style::color::ColorText));
+        }), 30);
+    } else {
+        this->m_list = new VirtualList(this->m_shownSize, JournalVisibleRows, JournalMarginRows, bind, click);
+        journalList->addItem(this->m_list, this->m_list->getListHeight());
+    }
+
+    rootFrame->setContent(journalList);
+    return rootFrame;
+}
+
+void GuiJournal::update() {
+    /* Launches being watched can still add events while the page is open. */
+    if (!this->m_engine.pollLaunches() || this->m_list == nullptr)
+        return;
+    this->m_shownSize = this->m_engine.journal().size();
+    this->m_list->setCount(this->m_shownSize);
+    this->m_list->refresh();
+}
@@ -0,0 +1,55 @@
+#include "gui_launches.hpp"
+
+#include <cstdio>
+
+static constexpr const char *const outcomeNames[] = {
+    [u32(LaunchTracker::Outcome::Watching)] = "watching",
+    [u32(LaunchTracker::Outcome::Running)] = "running",
+    [u32(LaunchTracker::Outcome::ExitedEarly)] = "exited early",
+    [u32(LaunchTracker::Outcome::NotVisible)] = "never seen",
+    [u32(LaunchTracker::Outcome::Stopped)] = "stopped",
+};
+
+static constexpr s32 LaunchRowHeight = 44;
+
+GuiLaunches::GuiLaunches(ModuleEngine &engine) : m_engine(engine) {}
+
+tsl::elm::Element *GuiLaunches::createUI() {
+    tsl::elm::OverlayFrame *rootFrame = new tsl::elm::OverlayFrame("Launch times", VERSION);
+    tsl::elm::List *launchList = new tsl::elm::List();
+
+    launchList->addItem(new tsl::elm::CategoryHeader("Recent launches  |    Back", true));
+    const u32 rows = std::max<u32>(this->m_engine.launches().count(), 1);
+    launchList->addItem(new tsl::elm::CustomDrawer([this](tsl::gfx::Renderer *renderer, s32 x, s32 y, s32 w, s32 h) {
+        const LaunchTracker &launches = this->m_engine.launches();
+        if (launches.count() == 0) {
+            renderer->drawString("  No module was started since the overlay opened.", false, x + 5, y + 20, 15, renderer->a(tsl::style::color::ColorDescription));
+            return;
+        }
+
+        /* Latencies are from the launch call to the process being seen, the window catches modules that crash on start. */
+        char line[96];
+        for (u32 i = 0; i < launches.count(); i++) {
+            const LaunchTracker::Record &record = launches.records()[i];
+            const s32 rowY = y + i * LaunchRowHeight;
+            const u32 module = this->m_engine.find(record.programId);
+            if (module != this->m_engine.modules().size())
+                std::snprintf(line, sizeof(line), "%.*s", int(this->m_engine.modules().name(module).size()), this->m_engine.modules().name(module).data());
+            else
+                std::snprintf(line, sizeof(line), "%016lX", record.programId);
+            renderer->drawString(line, false, x + 5, rowY + 18, 16, renderer->a(tsl::style::color::ColorText));
+
+            std::snprintf(line, sizeof(line), "Last %lu ms, best %lu ms  |  %u launches, %u early exits  |  %s", record.latencyNs / 1'000'000,
+                          record.bestLatencyNs / 1'000'000, record.launches, record.earlyExits, outcomeNames[u32(record.outcome)]);
+            renderer->drawString(line, false, x + 5, rowY + 38, 13, renderer->a(tsl::style::color::ColorDescription));
+        }
+    }), rows * LaunchRowHeight + 10);
+
+    rootFrame->setContent(launchList);
+    return rootFrame;
+}
+
+void GuiLaunches::update() {
+    /* Launches still being watched finish while the page is open. */
+    this->m_engine.pollLaunches();
+}
@@ -1,18 +1,16 @@
 #include "gui_main.hpp"
 
-#include "dir_iterator.hpp"
+#include "gui_heap.hpp"
+#include "gui_ipc.hpp"
+#include "gui_journal.hpp"
+#include "gui_launches.hpp"
+#include "heap_stats.hpp"
+#include "profiled_frame.hpp"
 
-#include <json.hpp>
-using json = nlohmann::json;
 constexpr const char *const bootFiledescriptions[2] = {
         [0] = "SXOS boot.dat",
         [1] = "SXGEAR boot.dat"
 };
-constexpr const char *const amsContentsPath = "/atmosphere/contents";
-constexpr const char *const boot2FlagFormat = "/atmosphere/contents/%016lX/flags/boot2.flag";
-constexpr const char *const boot2FlagFolder = "/atmosphere/contents/%016lX/flags";
-constexpr const char *const sxosTitlesPath = "/sxos/titles";
-static char pathBuffer[FS_MAX_PATH];
 
 constexpr const char *const descriptions[2][2] = {
     [0] = {
@@ -24,136 +22,229 @@ constexpr const char *const descriptions[2][2] = {
         [1] = "On | \uE0F4",
     },
 };
-static constexpr u32 AMSVersionConfigItem = 65000;
-GuiMain::GuiMain() {
-    Result rc = fsOpenSdCardFileSystem(&this->m_fs);
-    if (R_FAILED(rc))
-        return;
-    if (R_FAILED(rc = smInitialize())) return;
-
-    if (R_FAILED(rc = nifmInitialize(NifmServiceType_Admin))) return;
-
-    if (R_FAILED(rc = fsOpenSdCardFileSystem(&this->m_fs))) return;
-    if (R_SUCCEEDED(rc = splInitialize())) {
-        u64 version{0};
-        u32 version_micro{0xff};
-        u32 version_minor{0xff};
-        u32 version_major{0xff};
-        if (R_SUCCEEDED(rc = splGetConfig(static_cast<SplConfigItem>(AMSVersionConfigItem), &version))) {
-            version_micro = (version >> 40) & 0xff;
-            version_minor = (version >> 48) & 0xff;
-            version_major = (version >> 56) & 0xff;
+static constexpr u32 ModuleListVisibleRows = 5;
+static constexpr u32 ModuleListMarginRows = 2;
+/* Frames between checks whether titles were added or removed, about three seconds. */
+static constexpr u32 RescanInterval = 180;
+/* Frames between status polls of the bound rows, two calls per row. */
+static constexpr u32 StatusInterval = 20;
+/* There's no keyboard in an overlay, letters are picked from this with left and right. */
+static constexpr std::string_view SearchChars = "abcdefghijklmnopqrstuvwxyz0123456789-_ ";
+namespace {
+
+    /* "12.3 MB" */
+    void formatMegabytes(char *out, size_t size, u64 bytes) {
+        std::snprintf(out, size, "%lu.%lu MB", bytes >> 20, ((bytes & 0xFFFFF) * 10) >> 20);
+    }
+
+    /* What a launch of the module looks like so far, nullptr once there's nothing worth showing. */
+    const char *describeLaunch(const LaunchTracker::Record *launch, char *out, size_t size) {
+        if (launch == nullptr)
+            return nullptr;
+        if (launch->outcome == LaunchTracker::Outcome::ExitedEarly)
+            return "Exited early";
+        if (launch->outcome != LaunchTracker::Outcome::Watching)
+            return nullptr;
+        if (!launch->visible)
+            return "Starting";
+        std::snprintf(out, size, "Up in %lu ms", launch->latencyNs / 1'000'000);
+        return out;
+    }
+
+    /* "* Up in 85 ms | 12.3 MB | On | ...", the star marks modules selected for the memory estimate. */
+    std::string describeModule(const char *description, bool selected, const char *launch, bool showMemory, u64 usedBytes) {
+        std::string value = selected ? "* " : "";
+        if (launch != nullptr) {
+            value += launch;
+            value += " | ";
         }
-        splExit();
-        if (version_major == 0 && version_minor == 0 && version_micro == 0) {
-                this->m_bootRunning = BootDatType::SXOS_BOOT_TYPE;
-            std::strcpy(pathBuffer, sxosTitlesPath);
-        } else if ((version_major == 0 && version_minor >= 9 && version_micro >= 0) || (version_major == 1 && version_minor >= 0 && version_micro >= 0)) {
-                this->m_bootRunning = BootDatType::SXGEAR_BOOT_TYPE;
-            std::strcpy(pathBuffer, amsContentsPath);
-        } else {
-            return;
+        if (showMemory) {
+            char memory[24];
+            if (usedBytes != ModuleTable::UnknownMemoryUsage)
+                formatMegabytes(memory, sizeof(memory), usedBytes);
+            else
+                std::snprintf(memory, sizeof(memory), "? MB");
+            value += memory;
+            value += " | ";
         }
+        return value + description;
+    }
+
+    /* "3 started, 1 failed" */
+    std::string describeBatch(const ModuleEngine::BatchResult &result, const char *verb) {
+        std::string value = std::to_string(result.changed) + " " + verb;
+        if (result.failed > 0)
+            value += ", " + std::to_string(result.failed) + " failed";
+        return value;
     }
-    FsDir contentDir;
-    std::strcpy(pathBuffer, amsContentsPath);
-    rc = fsFsOpenDirectory(&this->m_fs, pathBuffer, FsDirOpenMode_ReadDirs, &contentDir);
-    if (R_FAILED(rc))
+
+}
+
+GuiMain::GuiMain() : m_engine(m_backend) {
+    if (R_FAILED(this->m_backend.initialize()))
         return;
-    tsl::hlp::ScopeGuard dirGuard([&] { fsDirClose(&contentDir); });
-
-    /* Iterate over contents folder. */
-    for (const auto &entry : FsDirIterator(contentDir)) {
-        FsFile toolboxFile;
-        std::snprintf(pathBuffer, FS_MAX_PATH, "/atmosphere/contents/%.*s/toolbox.json", FS_MAX_PATH - 35, entry.name);
-        rc = fsFsOpenFile(&this->m_fs, pathBuffer, FsOpenMode_Read, &toolboxFile);
-        if (R_FAILED(rc))
-            continue;
-        tsl::hlp::ScopeGuard fileGuard([&] { fsFileClose(&toolboxFile); });
 
-        /* Get toolbox file size. */
-        s64 size;
-        rc = fsFileGetSize(&toolboxFile, &size);
-        if (R_FAILED(rc))
-            continue;
+    resetHeapPeak();
+    this->m_engine.initialize();
+    recordHeapPhase(HeapPhase::Scan);
+}
 
-        /* Read toolbox file. */
-        std::string toolBoxData(size, '\0');
-        u64 bytesRead;
-        rc = fsFileRead(&toolboxFile, 0, toolBoxData.data(), size, FsReadOption_None, &bytesRead);
-        if (R_FAILED(rc))
-            continue;
+GuiMain::~GuiMain() {
+    /* Written once when the overlay exits, nothing touches the SD card for the journal while it's open. */
+    this->m_engine.flushJournal();
+}
 
-        /* Parse toolbox file data. */
-        json toolboxFileContent = json::parse(toolBoxData);
+u32 GuiMain::listModule(bool dynamic, u32 index) const {
+    if (this->m_query.empty())
+        return (dynamic ? 0 : this->m_engine.modules().staticBegin()) + index;
+    return this->m_matches[dynamic ? index : this->m_dynamicMatches + index];
+}
 
-        const std::string &sysmoduleProgramIdString = toolboxFileContent["tid"];
-        u64 sysmoduleProgramId = std::strtoul(sysmoduleProgramIdString.c_str(), nullptr, 16);
+u32 GuiMain::listCount(bool dynamic) const {
+    if (this->m_query.empty())
+        return dynamic ? this->m_engine.modules().dynamicCount() : this->m_engine.modules().staticCount();
+    return dynamic ? this->m_dynamicMatches : this->m_matches.size() - this->m_dynamicMatches;
+}
 
-        /* Let's not allow Tesla to be killed with this. */
-        if (sysmoduleProgramId == 0x420000000007E51AULL)
-            continue;
+void GuiMain::filter() {
+    const ModuleTable &modules = this->m_engine.modules();
+    if (this->m_query.empty()) {
+        this->m_matches.clear();
+        this->m_dynamicMatches = 0;
+        return;
+    }
 
-        SystemModule module = {
-            .listItem = new tsl::elm::ListItem(toolboxFileContent["name"]),
-            .programId = sysmoduleProgramId,
-            .needReboot = toolboxFileContent["requires_reboot"],
-        };
-
-        module.listItem->setClickListener([this, module](u64 click) -> bool {
-            /* if the folder "flags" does not exist, it will be created */
-            std::snprintf(pathBuffer, FS_MAX_PATH, boot2FlagFolder, module.programId);
-            fsFsCreateDirectory(&this->m_fs, pathBuffer);
-            std::snprintf(pathBuffer, FS_MAX_PATH, boot2FlagFormat, module.programId);
-
-            if (click & HidNpadButton_A && !module.needReboot) {
-                if (this->isRunning(module)) {
-                    /* Kill process. */
-                    pmshellTerminateProgram(module.programId);
-
-                    /* Remove boot2 flag file. */
-                    if (this->hasFlag(module))
-                        fsFsDeleteFile(&this->m_fs, pathBuffer);
-                } else {
-                    /* Start process. */
-                    const NcmProgramLocation programLocation{
-                        .program_id = module.programId,
-                        .storageID = NcmStorageId_None,
-                    };
-                    u64 pid = 0;
-                    pmshellLaunchProgram(0, &programLocation, &pid);
-
-                    /* Create boot2 flag file. */
-                    if (!this->hasFlag(module))
-                        fsFsCreateFile(&this->m_fs, pathBuffer, 0, FsCreateOption(0));
-                }
-                return true;
-            }
+    /* The vectors keep their capacity, a keystroke costs the matches it finds and nothing per module. */
+    this->m_found.resize(modules.size());
+    const u32 found = this->m_engine.search().find(this->m_query, this->m_found.data(), this->m_found.size());
+    this->m_matches.clear();
+    for (const bool dynamic : { true, false }) {
+        for (u32 i = 0; i < found; i++) {
+            if ((this->m_found[i] < modules.staticBegin()) == dynamic)
+                this->m_matches.push_back(this->m_found[i]);
+        }
+        if (dynamic)
+            this->m_dynamicMatches = this->m_matches.size();
+    }
+}
 
-            if (click & HidNpadButton_Y) {
-                if (this->hasFlag(module)) {
-                    /* Remove boot2 flag file. */
-                    fsFsDeleteFile(&this->m_fs, pathBuffer);
-                } else {
-                    /* Create boot2 flag file. */
-                    fsFsCreateFile(&this->m_fs, pathBuffer, 0, FsCreateOption(0));
-                }
-                return true;
-            }
+bool GuiMain::onSearchClick(tsl::elm::ListItem *item, u64 click) {
+    const u32 chars = SearchChars.size();
+    if (click & HidNpadButton_Left)
+        this->m_searchChar = (this->m_searchChar + chars - 1) % chars;
+    else if (click & HidNpadButton_Right)
+        this->m_searchChar = (this->m_searchChar + 1) % chars;
+    else if (click & HidNpadButton_A && this->m_query.size() < MaxSearchLength)
+        this->m_query += SearchChars[this->m_searchChar];
+    else if (click & HidNpadButton_Y && !this->m_query.empty())
+        this->m_query.pop_back();
+    else if (click & HidNpadButton_X)
+        this->m_query.clear();
+    else
+        return false;
 
-            return false;
-        });
-        this->m_sysmoduleListItems.push_back(std::move(module));
+    /* The shown char is bracketed, so a space can be told apart from nothing. */
+    item->setValue(this->m_query + "  [" + SearchChars[this->m_searchChar] + "]");
+    if (click & (HidNpadButton_Left | HidNpadButton_Right))
+        return true;
+
+    /* Only the rows on screen are bound again, typing never creates or frees list items. */
+    const u64 dynamicCursor = this->cursorProgramId(this->m_dynamicList, true);
+    const u64 staticCursor = this->cursorProgramId(this->m_staticList, false);
+    this->filter();
+    this->updateList(this->m_dynamicList, true, dynamicCursor);
+    this->updateList(this->m_staticList, false, staticCursor);
+    return true;
+}
+
+bool GuiMain::onModuleClick(u32 module, u64 click) {
+    if (click & HidNpadButton_A && !this->m_engine.modules().needReboot(module)) {
+        this->m_engine.toggleRunning(module);
+        this->refreshLists();
+        return true;
+    }
+
+    if (click & HidNpadButton_X) {
+        this->m_engine.toggleSelected(module);
+        this->refreshLists();
+        return true;
     }
-    this->m_scanned = true;
+
+    if (click & HidNpadButton_Y) {
+        this->m_engine.toggleAutoStart(module);
+        this->refreshLists();
+        return true;
+    }
+
+    return false;
 }
 
-GuiMain::~GuiMain() {
-    fsFsClose(&this->m_fs);
+VirtualList *GuiMain::createModuleList(bool dynamic) {
+    /*
+     * Rows are bound from the status cached in the table, binding makes no calls. poll() keeps the status of
+     * the bound rows up to date. The static list moves when a rescan changes the dynamic one.
+     */
+    auto bind = [this, dynamic](tsl::elm::ListItem *row, u32 index, bool recycled) {
+        const ModuleTable &modules = this->m_engine.modules();
+        u32 module = this->listModule(dynamic, index);
+        if (recycled)
+            row->setText(std::string(modules.name(module)));
+        const char *description = descriptions[modules.running(module)][modules.hasFlag(module)];
+        const bool selected = modules.selected(module), showMemory = this->m_showMemory && modules.running(module);
+        char launchText[24];
+        const char *launch = describeLaunch(this->m_engine.launches().find(modules.programId(module)), launchText, sizeof(launchText));
+        if (selected || showMemory || launch != nullptr)
+            row->setValue(describeModule(description, selected, launch, showMemory, modules.memoryUsage(module)));
+        else
+            row->setValue(description);
+    };
+    auto click = [this, dynamic](u32 index, u64 keys) -> bool {
+        return this->onModuleClick(this->listModule(dynamic, index), keys);
+    };
+
+    return new VirtualList(this->listCount(dynamic), ModuleListVisibleRows, ModuleListMarginRows, bind, click);
+}
+
+void GuiMain::rescan() {
+    /* The empty screen has no lists to put modules into. */
+    if (this->m_dynamicList == nullptr || this->m_staticList == nullptr)
+        return;
+
+    const u64 dynamicCursor = this->cursorProgramId(this->m_dynamicList, true);
+    const u64 staticCursor = this->cursorProgramId(this->m_staticList, false);
+    if (!this->m_engine.rescan())
+        return;
+
+    /* Module indices changed with the table, the matches are looked up again. */
+    this->filter();
+    this->updateList(this->m_dynamicList, true, dynamicCursor);
+    this->updateList(this->m_staticList, false, staticCursor);
+}
+
+u64 GuiMain::cursorProgramId(VirtualList *list, bool dynamic) const {
+    return list->getCount() > 0 ? this->m_engine.modules().programId(this->listModule(dynamic, list->getCursor())) : 0;
+}
+
+void GuiMain::updateList(VirtualList *list, bool dynamic, u64 cursorProgramId) {
+    /* The cursor stays on the module it was on, or where that module was if it's gone. */
+    const u32 count = this->listCount(dynamic);
+    u32 cursor = list->getCursor();
+    for (u32 index = 0; index < count; index++) {
+        if (this->m_engine.modules().programId(this->listModule(dynamic, index)) == cursorProgramId) {
+            cursor = index;
+            break;
+        }
+    }
+
+    const bool focused = list->ownsRow(this->getFocusedElement());
+    list->setCount(count, cursor);
+    if (focused)
+        this->requestFocus(count > 0 ? list : this->getTopElement(), tsl::FocusDirection::None, false);
 }
 
 tsl::elm::Element *GuiMain::createUI() {
-    tsl::elm::OverlayFrame *rootFrame = new tsl::elm::OverlayFrame("Sysmodules", VERSION);
+    resetHeapPeak();
+    tsl::elm::OverlayFrame *rootFrame = new ProfiledFrame("Sysmodules", VERSION, this->m_profiler);
     tsl::elm::List *sysmoduleList_base = new tsl::elm::List();
         sysmoduleList_base->addItem(new tsl::elm::CategoryHeader("SWITCH Power Control  |  \uE0E0  Restart and Power off", true));
         sysmoduleList_base->addItem(new tsl::elm::CustomDrawer([](tsl::gfx::Renderer *renderer, s32 x, s32 y, s32 w, s32 h) {
@@ -163,12 +254,8 @@ tsl::elm::Element *GuiMain::createUI() {
         powerResetListItem->setValue("|  \uE0F4");
         powerResetListItem->setClickListener([this, powerResetListItem](u64 click) -> bool {
             if (click & HidNpadButton_A) {
-                Result rc,rc1;
-                // if (R_FAILED(rc = bpcInitialize()) || R_FAILED(rc = bpcRebootSystem()))
-                if (R_FAILED(rc = spsmInitialize()) || R_FAILED(rc1 = spsmShutdown(true)))
-                    powerResetListItem->setText("failed! code:" + std::to_string(rc) + " , " + std::to_string(rc1));
-                spsmExit();
-                //bpcExit();
+                if (Result rc = this->m_backend.shutdown(true); R_FAILED(rc))
+                    powerResetListItem->setText("failed! code:" + std::to_string(rc));
                 return true;
             }
             return false;
@@ -178,12 +265,8 @@ tsl::elm::Element *GuiMain::createUI() {
         powerOffListItem->setValue("|  \uE098");
         powerOffListItem->setClickListener([this, powerOffListItem](u64 click) -> bool {
             if (click & HidNpadButton_A) {
-                Result rc,rc1;
-                // if (R_FAILED(rc = bpcInitialize()) || R_FAILED(rc = bpcShutdownSystem()))
-                if (R_FAILED(rc = spsmInitialize()) || R_FAILED(rc1 = spsmShutdown(false)))
-                    powerOffListItem->setText("failed! code:" + std::to_string(rc) + " , " + std::to_string(rc1));
-                spsmExit();
-                //bpcExit();
+                if (Result rc = this->m_backend.shutdown(false); R_FAILED(rc))
+                    powerOffListItem->setText("failed! code:" + std::to_string(rc));
                 return true;
             }
             return false;
@@ -197,9 +280,7 @@ tsl::elm::Element *GuiMain::createUI() {
     this->m_listItemSXOSBootType = new tsl::elm::ListItem(bootFiledescriptions[0]);
     this->m_listItemSXOSBootType->setClickListener([this, bootCatHeader](u64 click) -> bool {
         if (click & HidNpadButton_A) {
-            if (this->m_bootRunning == BootDatType::SXOS_BOOT_TYPE) return true;
-            Result rc;
-            rc = this->CopyFile("/bootloader/boot-sxos.dat", "/boot.dat");
+            Result rc = this->m_engine.selectBootDat(BootDatType::SXOS_BOOT_TYPE);
             if (R_FAILED(rc)) {
                 if (rc == 514) {
                     bootCatHeader->setText("Select SXOS boot.dat failed! Boot file not exist!");
@@ -208,14 +289,13 @@ tsl::elm::Element *GuiMain::createUI() {
                 }
                 return false;
             }
-            this->m_bootRunning = BootDatType::SXOS_BOOT_TYPE;
             return true;
         }
         return false;
     });
     
-    if (this->m_sysmoduleListItems.size() == 0) {
-        const char *description = this->m_scanned ? "No sysmodules found!" : "Scan failed!";
+    if (this->m_engine.modules().empty()) {
+        const char *description = this->m_engine.scanned() ? "No sysmodules found!" : "Scan failed!";
 
         auto *warning = new tsl::elm::CustomDrawer([description](tsl::gfx::Renderer *renderer, s32 x, s32 y, s32 w, s32 h) {
             renderer->drawString("\uE150", false, 180, 250, 90, renderer->a(0xFFFF));
@@ -225,100 +305,201 @@ tsl::elm::Element *GuiMain::createUI() {
         rootFrame->setContent(warning);
     } else {
         tsl::elm::List *sysmoduleList = new tsl::elm::List();
+        sysmoduleList->addItem(new tsl::elm::CategoryHeader("Memory budget  |  \uE0E2  Select for estimate", true));
+        sysmoduleList->addItem(new tsl::elm::CustomDrawer([this](tsl::gfx::Renderer *renderer, s32 x, s32 y, s32 w, s32 h) {
+            this->drawMemoryBudget(renderer, x, y);
+        }), 75);
+
+        sysmoduleList->addItem(new tsl::elm::CategoryHeader("Selected  |  \uE0E0  Start or stop with dependencies", true));
+        for (const bool start : { true, false }) {
+            tsl::elm::ListItem *batchListItem = new tsl::elm::ListItem(start ? "Start selected" : "Stop selected");
+            batchListItem->setClickListener([this, batchListItem, start](u64 click) -> bool {
+                if (click & HidNpadButton_A) {
+                    const ModuleEngine::BatchResult result = start ? this->m_engine.startSelected() : this->m_engine.stopSelected();
+                    batchListItem->setValue(describeBatch(result, start ? "started" : "stopped"));
+                    this->refreshLists();
+                    return true;
+                }
+                return false;
+            });
+            sysmoduleList->addItem(batchListItem);
+        }
+
+        sysmoduleList->addItem(new tsl::elm::CategoryHeader("Search  |  \uE0E0  Add  |  \uE0E3  Delete  |  \uE0E2  Clear", true));
+        sysmoduleList->addItem(new tsl::elm::CustomDrawer([](tsl::gfx::Renderer *renderer, s32 x, s32 y, s32 w, s32 h) {
+            renderer->drawString("\uE016  Pick letters with left and right, by name or program id.", false, x + 5, y + 20, 15, renderer->a(tsl::style::color::ColorDescription));
+        }), 30);
+        tsl::elm::ListItem *searchListItem = new tsl::elm::ListItem("Search");
+        searchListItem->setValue(std::string("  [") + SearchChars[this->m_searchChar] + "]");
+        searchListItem->setClickListener([this, searchListItem](u64 click) -> bool {
+            return this->onSearchClick(searchListItem, click);
+        });
+        sysmoduleList->addItem(searchListItem);
+
         sysmoduleList->addItem(new tsl::elm::CategoryHeader("Dynamic  |  \uE0E0  Toggle  |  \uE0E3  Toggle auto start", true));
         sysmoduleList->addItem(new tsl::elm::CustomDrawer([](tsl::gfx::Renderer *renderer, s32 x, s32 y, s32 w, s32 h) {
             renderer->drawString("\uE016  These sysmodules can be toggled at any time.", false, x + 5, y + 20, 15, renderer->a(tsl::style::color::ColorDescription));
         }), 30);
-        for (const auto &module : this->m_sysmoduleListItems) {
-            if (!module.needReboot)
-                sysmoduleList->addItem(module.listItem);
-        }
+        this->m_dynamicList = this->createModuleList(true);
+        sysmoduleList->addItem(this->m_dynamicList, this->m_dynamicList->getListHeight());
 
         sysmoduleList->addItem(new tsl::elm::CategoryHeader("Static  |  \uE0E3  Toggle auto start", true));
         sysmoduleList->addItem(new tsl::elm::CustomDrawer([](tsl::gfx::Renderer *renderer, s32 x, s32 y, s32 w, s32 h) {
             renderer->drawString("\uE016  These sysmodules need a reboot to work.", false, x + 5, y + 20, 15, renderer->a(tsl::style::color::ColorDescription));
         }), 30);
-        for (const auto &module : this->m_sysmoduleListItems) {
-            if (module.needReboot)
-                sysmoduleList->addItem(module.listItem);
-        }
+        this->m_staticList = this->createModuleList(false);
+        sysmoduleList->addItem(this->m_staticList, this->m_staticList->getListHeight());
+
+        sysmoduleList->addItem(new tsl::elm::CategoryHeader("Diagnostics", true));
+        tsl::elm::ListItem *heapListItem = new tsl::elm::ListItem("Heap usage");
+        heapListItem->setClickListener([](u64 click) -> bool {
+            if (click & HidNpadButton_A) {
+                tsl::changeTo<GuiHeap>();
+                return true;
+            }
+            return false;
+        });
+        sysmoduleList->addItem(heapListItem);
+
+        tsl::elm::ListItem *ipcListItem = new tsl::elm::ListItem("Service calls");
+        ipcListItem->setClickListener([](u64 click) -> bool {
+            if (click & HidNpadButton_A) {
+                tsl::changeTo<GuiIpc>();
+                return true;
+            }
+            return false;
+        });
+        sysmoduleList->addItem(ipcListItem);
+
+        tsl::elm::ListItem *launchListItem = new tsl::elm::ListItem("Launch times");
+        launchListItem->setClickListener([this](u64 click) -> bool {
+            if (click & HidNpadButton_A) {
+                tsl::changeTo<GuiLaunches>(this->m_engine);
+                return true;
+            }
+            return false;
+        });
+        sysmoduleList->addItem(launchListItem);
+
+        tsl::elm::ListItem *journalListItem = new tsl::elm::ListItem("Event journal");
+        journalListItem->setClickListener([this](u64 click) -> bool {
+            if (click & HidNpadButton_A) {
+                tsl::changeTo<GuiJournal>(this->m_engine);
+                return true;
+            }
+            return false;
+        });
+        sysmoduleList->addItem(journalListItem);
+
+        tsl::elm::ListItem *memoryListItem = new tsl::elm::ListItem("Memory usage column");
+        memoryListItem->setValue("Off");
+        memoryListItem->setClickListener([this, memoryListItem](u64 click) -> bool {
+            if (click & HidNpadButton_A) {
+                this->m_showMemory = !this->m_showMemory;
+                memoryListItem->setValue(this->m_showMemory ? "On" : "Off");
+                this->m_engine.invalidateUsage();
+                this->refreshLists();
+                return true;
+            }
+            return false;
+        });
+        sysmoduleList->addItem(memoryListItem);
+
+        tsl::elm::ListItem *profilerListItem = new tsl::elm::ListItem("Frame profiler");
+        profilerListItem->setValue("Off");
+        profilerListItem->setClickListener([this, profilerListItem](u64 click) -> bool {
+            if (click & HidNpadButton_A) {
+                this->m_profiler.setEnabled(!this->m_profiler.enabled());
+                profilerListItem->setValue(this->m_profiler.enabled() ? "On" : "Off");
+                return true;
+            }
+            return false;
+        });
+        sysmoduleList->addItem(profilerListItem);
         rootFrame->setContent(sysmoduleList);
     }
 
+    recordHeapPhase(HeapPhase::CreateUI);
     return rootFrame;
 }
 
 void GuiMain::update() {
-    static u32 counter = 0;
-
-    if (counter++ % 20 != 0)
+    if (!this->m_profiler.enabled()) {
+        this->poll();
         return;
-
-    for (const auto &module : this->m_sysmoduleListItems) {
-        this->updateStatus(module);
     }
-}
 
-void GuiMain::updateStatus(const SystemModule &module) {
-    bool running = this->isRunning(module);
-    bool hasFlag = this->hasFlag(module);
+    const u64 start = armGetSystemTick();
+    this->poll();
+    this->m_profiler.recordUpdate(armGetSystemTick() - start);
+}
 
-    const char *desc = descriptions[running][hasFlag];
-    module.listItem->setValue(desc);
+void GuiMain::poll() {
+    static u32 counter = 0;
+    const u32 frame = counter++;
+
+    if (frame % RescanInterval == RescanInterval - 1)
+        this->rescan();
+    /* Rows that were bound without a status yet, after scrolling, a search or a rescan, are polled on the next frame. */
+    const bool statusFrame = frame % StatusInterval == 0;
+    const bool polled = this->pollStatus(this->m_dynamicList, true, statusFrame) | this->pollStatus(this->m_staticList, false, statusFrame);
+    /* Freshly launched modules are followed on every frame, so they show up or drop out without waiting for the poll. */
+    if (this->m_engine.pollLaunches() || polled || statusFrame)
+        this->refreshLists();
 }
 
-bool GuiMain::hasFlag(const SystemModule &module) {
-    FsFile flagFile;
-    std::snprintf(pathBuffer, FS_MAX_PATH, boot2FlagFormat, module.programId);
-    Result rc = fsFsOpenFile(&this->m_fs, pathBuffer, FsOpenMode_Read, &flagFile);
-    if (R_SUCCEEDED(rc)) {
-        fsFileClose(&flagFile);
-        return true;
-    } else {
+bool GuiMain::pollStatus(VirtualList *list, bool dynamic, bool all) {
+    if (list == nullptr)
         return false;
+
+    bool polled = false;
+    for (u32 index = list->getBoundBegin(); index < list->getBoundEnd(); index++) {
+        const u32 module = this->listModule(dynamic, index);
+        if (!all && this->m_engine.modules().statusKnown(module))
+            continue;
+        this->m_engine.updateStatus(module);
+        polled = true;
     }
+    return polled;
 }
 
-bool GuiMain::isRunning(const SystemModule &module) {
-    u64 pid = 0;
-    if (R_FAILED(pmdmntGetProcessId(&pid, module.programId)))
-        return false;
+void GuiMain::drawMemoryBudget(tsl::gfx::Renderer *renderer, s32 x, s32 y) {
+    const auto color = renderer->a(tsl::style::color::ColorDescription);
+    if (!this->m_showMemory) {
+        renderer->drawString("\uE016  Turn on the memory usage column below to sample modules.", false, x + 5, y + 20, 15, color);
+        return;
+    }
 
-    return pid > 0;
-}
-Result GuiMain::CopyFile(const char *srcPath, const char *destPath) {
-    Result ret{0};
-    FsFile src_handle, dest_handle;
-    if (R_FAILED(ret = fsFsOpenFile(&this->m_fs, srcPath, FsOpenMode_Read, &src_handle))) return ret;
-    tsl::hlp::ScopeGuard fileGuard1([&] { fsFileClose(&src_handle); });
-
-    s64 size = 0;
-    if (R_FAILED(ret = fsFileGetSize(&src_handle, &size))) return ret;
-
-    if (R_SUCCEEDED(fsFsOpenFile(&this->m_fs, destPath, FsOpenMode_Read, &dest_handle))) {
-        fsFileClose(&dest_handle);
-        if (R_FAILED(ret = fsFsDeleteFile(&this->m_fs, destPath))) return ret;
-	    if (R_FAILED(ret = fsFsCreateFile(&this->m_fs, destPath, size, 0))) return ret;
+    /* Only reads totals the table keeps up to date, drawing this costs nothing per module. */
+    const ModuleTable &modules = this->m_engine.modules();
+    const UsageSampler &usage = this->m_engine.usage();
+    char line[96], used[24], headroom[24], size[24];
+    formatMegabytes(used, sizeof(used), modules.totalMemoryUsage());
+    std::snprintf(line, sizeof(line), "Running sysmodules use %s", used);
+    renderer->drawString(line, false, x + 5, y + 20, 15, color);
+
+    formatMegabytes(headroom, sizeof(headroom), usage.poolHeadroom());
+    formatMegabytes(size, sizeof(size), usage.poolSize());
+    std::snprintf(line, sizeof(line), "System pool: %s free of %s", headroom, size);
+    renderer->drawString(line, false, x + 5, y + 42, 15, color);
+
+    if (modules.selectedCount() == 0) {
+        renderer->drawString("\uE016  Select modules to see what stopping them frees.", false, x + 5, y + 64, 15, color);
+        return;
     }
+    formatMegabytes(used, sizeof(used), modules.selectedMemoryUsage());
+    formatMegabytes(headroom, sizeof(headroom), usage.poolHeadroom() + modules.selectedMemoryUsage());
+    std::snprintf(line, sizeof(line), "Stopping %u selected frees %s, %s free", modules.selectedCount(), used, headroom);
+    renderer->drawString(line, false, x + 5, y + 64, 15, color);
+}
+
+void GuiMain::refreshLists() {
+    /* Rate limited by the sampler, most refreshes just show the cached usage. */
+    if (this->m_showMemory)
+        this->m_engine.sampleUsage();
 
-    if (R_FAILED(ret = fsFsOpenFile(&this->m_fs, destPath, FsOpenMode_Write, &dest_handle))) return ret;
-    tsl::hlp::ScopeGuard fileGuard2([&] { fsFileClose(&dest_handle); });
-
-    u64 bytes_read = 0;
-    const u64 buf_size = 0x10000;
-    s64 offset = 0;
-    unsigned char *buf = new unsigned char[buf_size];
-    tsl::hlp::ScopeGuard fileGuard3([&] { delete[] buf; });
-    std::string str(srcPath);
-    std::size_t pos = str.rfind("/");     
-    std::string filename = str.substr(pos); 
-
-    do {
-        std::memset(buf, 0, buf_size);
-        if (R_FAILED(ret = fsFileRead(&src_handle, offset, buf, buf_size, FsReadOption_None, &bytes_read))) return ret;
-        if (R_FAILED(ret = fsFileWrite(&dest_handle, offset, buf, bytes_read, FsWriteOption_Flush))) return ret;
-        offset += bytes_read;
-    } while(offset < size);
-
-    return ret;
+    if (this->m_dynamicList != nullptr)
+        this->m_dynamicList->refresh();
+    if (this->m_staticList != nullptr)
+        this->m_staticList->refresh();
 }
@@ -0,0 +1,165 @@
+#include "headless.hpp"
+
+#include "module_engine.hpp"
+#include "program_id.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+    std::string_view trim(std::string_view line) {
+        while (!line.empty() && (line.front() == ' ' || line.front() == '\t'))
+            line.remove_prefix(1);
+        while (!line.empty() && (line.back() == ' ' || line.back() == '\t' || line.back() == '\r'))
+            line.remove_suffix(1);
+        return line;
+    }
+
+    bool parseAction(std::string_view verb, std::string_view programId, HeadlessAction &action) {
+        if (verb == "start")
+            action.start = true;
+        else if (verb == "stop")
+            action.start = false;
+        else
+            return false;
+        return parseProgramId(programId, action.programId);
+    }
+
+}
+
+bool isHeadlessLaunch(int argc, char **argv) {
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--profile") == 0 || std::strcmp(argv[i], "--start") == 0 || std::strcmp(argv[i], "--stop") == 0)
+            return true;
+    }
+    return false;
+}
+
+bool parseProfile(std::string_view data, HeadlessAction *actions, u32 &count) {
+    /* Counted separately, so a profile that doesn't parse leaves none of its actions behind. */
+    u32 parsed = count;
+    while (!data.empty()) {
+        const size_t end = data.find('\n');
+        const std::string_view line = trim(data.substr(0, end));
+        data.remove_prefix(end == std::string_view::npos ? data.size() : end + 1);
+        if (line.empty() || line.front() == '#')
+            continue;
+
+        const size_t space = line.find_first_of(" \t");
+        if (space == std::string_view::npos || parsed == MaxHeadlessActions)
+            return false;
+        if (!parseAction(line.substr(0, space), trim(line.substr(space)), actions[parsed]))
+            return false;
+        parsed++;
+    }
+    count = parsed;
+    return true;
+}
+
+u32 runHeadless(Backend &backend, int argc, char **argv) {
+    HeadlessAction actions[MaxHeadlessActions];
+    u32 count = 0, failed = 0;
+
+    /* Arguments are pairs. Only Tesla's own flag may come along, anything else means the command line is wrong, and none of it is applied. */
+    for (int i = 1; i < argc; i++) {
+        const std::string_view arg = argv[i];
+        if (arg == "--profile" || arg == "--start" || arg == "--stop") {
+            if (++i == argc)
+                return HeadlessUsageError;
+        } else if (arg != "--skipCombo") {
+            return HeadlessUsageError;
+        }
+    }
+
+    ScanArena arena;
+    for (int i = 1; i < argc; i++) {
+        const std::string_view arg = argv[i];
+        if (arg == "--profile") {
+            char path[FS_MAX_PATH];
+            std::string_view data;
+            std::snprintf(path, sizeof(path), "%s/%s.txt", ProfileDirectory, argv[++i]);
+            if (R_FAILED(backend.readFile(path, arena, data)) || !parseProfile(data, actions, count))
+                failed++;
+        } else if (arg == "--start" || arg == "--stop") {
+            if (count == MaxHeadlessActions || !parseAction(arg.substr(2), argv[++i], actions[count]))
+                failed++;
+            else
+                count++;
+        }
+    }
+
+    /* One entry per module, with the last action named for it. */
+    u64 programIds[MaxHeadlessModules];
+    bool start[MaxHeadlessModules];
+    u32 named = 0;
+    for (u32 i = 0; i < count; i++) {
+        u32 id = 0;
+        while (id < named && programIds[id] != actions[i].programId)
+            id++;
+        programIds[id] = actions[i].programId;
+        start[id] = actions[i].start;
+        named += id == named;
+    }
+
+    /*
+     * Only the named modules are read, which is a few files instead of every
+     * title directory. Whatever a module that's started depends on is read as
+     * well, until nothing new turns up.
+     */
+    ModuleEngine engine(backend);
+    u32 loaded = 0, idCount = named, droppedCount = 0;
+    u64 *dropped = nullptr;
+    while (loaded != idCount) {
+        if (R_FAILED(engine.loadTitles(programIds, idCount)))
+            return failed + named;
+        loaded = idCount;
+
+        /* The last pass sees every dependency that didn't fit, earlier ones are redone anyway. */
+        const ModuleTable &modules = engine.modules();
+        u32 edgeCount = 0;
+        for (u32 module = 0; module < modules.size(); module++)
+            edgeCount += modules.dependencies(module).size();
+        dropped = arena.allocateArray<u64>(edgeCount);
+        droppedCount = 0;
+
+        for (u32 module = 0; module < modules.size(); module++) {
+            const u32 id = std::find(programIds, programIds + loaded, modules.programId(module)) - programIds;
+            if (id < named && !start[id])
+                continue;
+            for (u64 dependency : modules.dependencies(module)) {
+                if (std::find(programIds, programIds + idCount, dependency) != programIds + idCount)
+                    continue;
+                if (idCount < MaxHeadlessModules)
+                    programIds[idCount++] = dependency;
+                else if (dropped != nullptr)
+                    dropped[droppedCount++] = dependency;
+            }
+        }
+    }
+
+    /* A dependency that didn't fit can't be started, unless it's already running that's a failure of its own. */
+    if (dropped != nullptr) {
+        std::sort(dropped, dropped + droppedCount);
+        droppedCount = std::unique(dropped, dropped + droppedCount) - dropped;
+        for (u32 i = 0; i < droppedCount; i++)
+            failed += !backend.isRunning(dropped[i]);
+    }
+
+    u32 stops[MaxHeadlessModules], starts[MaxHeadlessModules];
+    u32 stopCount = 0, startCount = 0;
+    for (u32 id = 0; id < named; id++) {
+        const u32 module = engine.find(programIds[id]);
+        if (module == engine.modules().size())
+            failed++;
+        else if (start[id])
+            starts[startCount++] = module;
+        else
+            stops[stopCount++] = module;
+    }
+    failed += engine.stopModules(stops, stopCount).failed;
+    failed += engine.startModules(starts, startCount).failed;
+    engine.flushJournal();
+    return failed;
+}
@@ -0,0 +1,198 @@
+#include "heap_stats.hpp"
+
+#include <atomic>
+#include <bit>
+#include <malloc.h>
+
+extern "C" {
+    void *__real_malloc(size_t size);
+    void *__real_calloc(size_t count, size_t size);
+    void *__real_realloc(void *ptr, size_t size);
+    void *__real_memalign(size_t alignment, size_t size);
+    void *__real_aligned_alloc(size_t alignment, size_t size);
+    void __real_free(void *ptr);
+
+#ifdef __SWITCH__
+    /* newlib's reentrant versions, which the functions above and newlib itself call. */
+    void *__real__malloc_r(struct _reent *reent, size_t size);
+    void *__real__calloc_r(struct _reent *reent, size_t count, size_t size);
+    void *__real__realloc_r(struct _reent *reent, void *ptr, size_t size);
+    void *__real__memalign_r(struct _reent *reent, size_t alignment, size_t size);
+    void __real__free_r(struct _reent *reent, void *ptr);
+#endif
+}
+
+namespace {
+
+    std::atomic<u64> g_currentBytes;
+    std::atomic<u64> g_peakBytes;
+    std::atomic<u64> g_allocations;
+    std::atomic<u64> g_frees;
+    std::atomic<u64> g_histogram[HeapStats::Buckets];
+
+    HeapCheckpoint g_phases[u32(HeapPhase::Count)];
+
+    /*
+     * Allocator calls made from within a wrapped one, like malloc calling
+     * _malloc_r or realloc moving the block with malloc and free. Only the
+     * outermost call is counted.
+     */
+    thread_local u32 g_depth;
+
+    struct Nested {
+        bool outermost;
+        Nested() : outermost(g_depth++ == 0) {}
+        ~Nested() { g_depth--; }
+    };
+
+    constexpr u32 bucketOf(size_t size) {
+        u32 width = std::bit_width(size);
+        if (width <= 4)
+            return 0;
+        return width - 4 < HeapStats::Buckets ? width - 4 : HeapStats::Buckets - 1;
+    }
+
+    static_assert(bucketOf(0) == 0 && bucketOf(15) == 0);
+    static_assert(bucketOf(16) == 1 && bucketOf(31) == 1 && bucketOf(32) == 2);
+    static_assert(HeapStats::bucketFloor(bucketOf(4096)) == 4096);
+    static_assert(bucketOf(size_t(1) << 40) == HeapStats::Buckets - 1);
+
+    void *track(void *ptr) {
+        if (ptr == nullptr)
+            return ptr;
+
+        size_t size = malloc_usable_size(ptr);
+        u64 current = g_currentBytes.fetch_add(size, std::memory_order_relaxed) + size;
+        u64 peak = g_peakBytes.load(std::memory_order_relaxed);
+        while (current > peak && !g_peakBytes.compare_exchange_weak(peak, current, std::memory_order_relaxed))
+            ;
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+        g_histogram[bucketOf(size)].fetch_add(1, std::memory_order_relaxed);
+        return ptr;
+    }
+
+    void untrack(void *ptr) {
+        if (ptr == nullptr)
+            return;
+
+        g_currentBytes.fetch_sub(malloc_usable_size(ptr), std::memory_order_relaxed);
+        g_frees.fetch_add(1, std::memory_order_relaxed);
+    }
+
+}
+
+void getHeapStats(HeapStats &stats) {
+    stats.currentBytes = g_currentBytes.load(std::memory_order_relaxed);
+    stats.peakBytes = g_peakBytes.load(std::memory_order_relaxed);
+    stats.allocations = g_allocations.load(std::memory_order_relaxed);
+    stats.frees = g_frees.load(std::memory_order_relaxed);
+    for (u32 i = 0; i < HeapStats::Buckets; i++)
+        stats.histogram[i] = g_histogram[i].load(std::memory_order_relaxed);
+}
+
+void resetHeapPeak() {
+    g_peakBytes.store(g_currentBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+void recordHeapPhase(HeapPhase phase) {
+    g_phases[u32(phase)] = {
+        .currentBytes = g_currentBytes.load(std::memory_order_relaxed),
+        .peakBytes = g_peakBytes.load(std::memory_order_relaxed),
+        .allocations = g_allocations.load(std::memory_order_relaxed),
+        .taken = true,
+    };
+    resetHeapPeak();
+}
+
+const HeapCheckpoint &getHeapPhase(HeapPhase phase) {
+    return g_phases[u32(phase)];
+}
+
+/* Only used when the link routes the allocator through here with -Wl,--wrap. */
+namespace {
+
+    template <typename F>
+    void *allocate(F &&allocator) {
+        Nested nested;
+        void *ptr = allocator();
+        return nested.outermost ? track(ptr) : ptr;
+    }
+
+    template <typename F>
+    void *reallocate(void *ptr, size_t size, F &&reallocator) {
+        Nested nested;
+        if (!nested.outermost)
+            return reallocator();
+
+        /* The old block is gone once realloc succeeds, and untouched if it fails. */
+        size_t oldSize = ptr != nullptr ? malloc_usable_size(ptr) : 0;
+        void *result = reallocator();
+        if (result == nullptr && size > 0)
+            return result;
+
+        if (ptr != nullptr) {
+            g_currentBytes.fetch_sub(oldSize, std::memory_order_relaxed);
+            g_frees.fetch_add(1, std::memory_order_relaxed);
+        }
+        return track(result);
+    }
+
+    template <typename F>
+    void release(void *ptr, F &&releaser) {
+        Nested nested;
+        if (nested.outermost)
+            untrack(ptr);
+        releaser();
+    }
+
+}
+
+extern "C" {
+
+    void *__wrap_malloc(size_t size) {
+        return allocate([&] { return __real_malloc(size); });
+    }
+
+    void *__wrap_calloc(size_t count, size_t size) {
+        return allocate([&] { return __real_calloc(count, size); });
+    }
+
+    void *__wrap_realloc(void *ptr, size_t size) {
+        return reallocate(ptr, size, [&] { return __real_realloc(ptr, size); });
+    }
+
+    void *__wrap_memalign(size_t alignment, size_t size) {
+        return allocate([&] { return __real_memalign(alignment, size); });
+    }
+
+    void *__wrap_aligned_alloc(size_t alignment, size_t size) {
+        return allocate([&] { return __real_aligned_alloc(alignment, size); });
+    }
+
+    void __wrap_free(void *ptr) {
+        release(ptr, [&] { __real_free(ptr); });
+    }
+
+#ifdef __SWITCH__
+    void *__wrap__malloc_r(struct _reent *reent, size_t size) {
+        return allocate([&] { return __real__malloc_r(reent, size); });
+    }
+
+    void *__wrap__calloc_r(struct _reent *reent, size_t count, size_t size) {
+        return allocate([&] { return __real__calloc_r(reent, count, size); });
+    }
+
+    void *__wrap__realloc_r(struct _reent *reent, void *ptr, size_t size) {
+        return reallocate(ptr, size, [&] { return __real__realloc_r(reent, ptr, size); });
+    }
+
+    void *__wrap__memalign_r(struct _reent *reent, size_t alignment, size_t size) {
+        return allocate([&] { return __real__memalign_r(reent, alignment, size); });
+    }
+
+    void __wrap__free_r(struct _reent *reent, void *ptr) {
+        release(ptr, [&] { __real__free_r(reent, ptr); });
+    }
+#endif
+
+}
@@ -0,0 +1,88 @@
+#include "ipc_stats.hpp"
+
+#include <atomic>
+#include <bit>
+
+namespace {
+
+    constexpr const char *const callNames[u32(IpcCall::Count)] = {
+        [u32(IpcCall::FsOpenSdCardFileSystem)] = "fsOpenSdCardFileSystem",
+        [u32(IpcCall::FsOpenDirectory)] = "fsFsOpenDirectory",
+        [u32(IpcCall::FsDirRead)] = "fsDirRead",
+        [u32(IpcCall::FsDirClose)] = "fsDirClose",
+        [u32(IpcCall::FsOpenFile)] = "fsFsOpenFile",
+        [u32(IpcCall::FsFileRead)] = "fsFileRead",
+        [u32(IpcCall::FsFileWrite)] = "fsFileWrite",
+        [u32(IpcCall::FsFileGetSize)] = "fsFileGetSize",
+        [u32(IpcCall::FsFileClose)] = "fsFileClose",
+        [u32(IpcCall::FsCreateFile)] = "fsFsCreateFile",
+        [u32(IpcCall::FsDeleteFile)] = "fsFsDeleteFile",
+        [u32(IpcCall::FsCreateDirectory)] = "fsFsCreateDirectory",
+        [u32(IpcCall::FsGetFileTimeStamp)] = "fsFsGetFileTimeStampRaw",
+        [u32(IpcCall::PmdmntGetProcessId)] = "pmdmntGetProcessId",
+        [u32(IpcCall::PmdmntGetProcessInfo)] = "pmdmntAtmosphereGetProcessInfo",
+        [u32(IpcCall::PmshellLaunchProgram)] = "pmshellLaunchProgram",
+        [u32(IpcCall::PmshellTerminateProgram)] = "pmshellTerminateProgram",
+        [u32(IpcCall::SvcGetInfo)] = "svcGetInfo",
+        [u32(IpcCall::SvcGetSystemInfo)] = "svcGetSystemInfo",
+        [u32(IpcCall::SplGetConfig)] = "splGetConfig",
+        [u32(IpcCall::SpsmShutdown)] = "spsmShutdown",
+    };
+
+    struct Counters {
+        std::atomic<u64> calls;
+        std::atomic<u64> failures;
+        std::atomic<u64> totalNs;
+        std::atomic<u64> maxNs;
+        std::atomic<u64> histogram[IpcCallStats::Buckets];
+    };
+
+    Counters g_counters[u32(IpcCall::Count)];
+
+    constexpr u32 bucketOf(u64 us) {
+        const u32 width = std::bit_width(us);
+        return width < IpcCallStats::Buckets ? width : IpcCallStats::Buckets - 1;
+    }
+
+    static_assert(bucketOf(0) == 0 && bucketOf(1) == 1 && bucketOf(2) == 2 && bucketOf(3) == 2);
+    static_assert(IpcCallStats::bucketFloorUs(bucketOf(1024)) == 1024);
+    static_assert(bucketOf(u64(1) << 40) == IpcCallStats::Buckets - 1);
+
+}
+
+const char *ipcCallName(IpcCall call) {
+    return call < IpcCall::Count ? callNames[u32(call)] : "unknown";
+}
+
+void recordIpcCall(IpcCall call, u64 ticks, bool failed) {
+    Counters &counters = g_counters[u32(call)];
+    const u64 ns = armTicksToNs(ticks);
+    counters.calls.fetch_add(1, std::memory_order_relaxed);
+    counters.failures.fetch_add(failed, std::memory_order_relaxed);
+    counters.totalNs.fetch_add(ns, std::memory_order_relaxed);
+    u64 max = counters.maxNs.load(std::memory_order_relaxed);
+    while (ns > max && !counters.maxNs.compare_exchange_weak(max, ns, std::memory_order_relaxed))
+        ;
+    counters.histogram[bucketOf(ns / 1000)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void getIpcStats(IpcCall call, IpcCallStats &stats) {
+    const Counters &counters = g_counters[u32(call)];
+    stats.calls = counters.calls.load(std::memory_order_relaxed);
+    stats.failures = counters.failures.load(std::memory_order_relaxed);
+    stats.totalNs = counters.totalNs.load(std::memory_order_relaxed);
+    stats.maxNs = counters.maxNs.load(std::memory_order_relaxed);
+    for (u32 bucket = 0; bucket < IpcCallStats::Buckets; bucket++)
+        stats.histogram[bucket] = counters.histogram[bucket].load(std::memory_order_relaxed);
+}
+
+void resetIpcStats() {
+    for (Counters &counters : g_counters) {
+        counters.calls.store(0, std::memory_order_relaxed);
+        counters.failures.store(0, std::memory_order_relaxed);
+        counters.totalNs.store(0, std::memory_order_relaxed);
+        counters.maxNs.store(0, std::memory_order_relaxed);
+        for (auto &bucket : counters.histogram)
+            bucket.store(0, std::memory_order_relaxed);
+    }
+}
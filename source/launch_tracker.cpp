@@ -0,0 +1,86 @@
+#include "launch_tracker.hpp"
+
+LaunchTracker::LaunchTracker(u64 windowNs) : m_windowTicks(armNsToTicks(windowNs)) {}
+
+const LaunchTracker::Record *LaunchTracker::find(u64 programId) const {
+    for (u32 i = 0; i < this->m_count; i++) {
+        if (this->m_records[i].programId == programId)
+            return &this->m_records[i];
+    }
+    return nullptr;
+}
+
+void LaunchTracker::launched(u64 programId, u64 launchTick) {
+    Record *record = nullptr;
+    for (u32 i = 0; record == nullptr && i < this->m_count; i++) {
+        if (this->m_records[i].programId == programId)
+            record = &this->m_records[i];
+    }
+    if (record == nullptr && this->m_count < MaxRecords) {
+        record = &this->m_records[this->m_count++];
+        *record = { .programId = programId, .outcome = Outcome::Running };
+    }
+
+    /* Full, the module launched longest ago that isn't watched anymore gives up its record. */
+    if (record == nullptr) {
+        for (u32 i = 0; i < this->m_count; i++) {
+            Record &candidate = this->m_records[i];
+            if (candidate.outcome != Outcome::Watching && (record == nullptr || candidate.launchTick < record->launchTick))
+                record = &candidate;
+        }
+        if (record == nullptr)
+            return;
+        *record = { .programId = programId, .outcome = Outcome::Running };
+    }
+
+    this->m_watching += record->outcome != Outcome::Watching;
+    record->outcome = Outcome::Watching;
+    record->visible = false;
+    record->latencyNs = 0;
+    record->launchTick = launchTick;
+    record->launches++;
+}
+
+void LaunchTracker::stopped(u64 programId) {
+    for (u32 i = 0; i < this->m_count; i++) {
+        Record &record = this->m_records[i];
+        if (record.programId == programId && record.outcome == Outcome::Watching) {
+            record.outcome = Outcome::Stopped;
+            this->m_watching--;
+        }
+    }
+}
+
+bool LaunchTracker::poll(Backend &backend) {
+    if (this->m_watching == 0)
+        return false;
+
+    bool changed = false;
+    for (u32 i = 0; i < this->m_count; i++) {
+        Record &record = this->m_records[i];
+        if (record.outcome != Outcome::Watching)
+            continue;
+
+        /* Taken after asking, a process seen now was up by then at the latest. */
+        const bool running = backend.isRunning(record.programId);
+        const u64 now = armGetSystemTick();
+        if (running && !record.visible) {
+            record.visible = true;
+            record.latencyNs = armTicksToNs(now - record.launchTick);
+            if (record.bestLatencyNs == 0 || record.latencyNs < record.bestLatencyNs)
+                record.bestLatencyNs = record.latencyNs;
+            changed = true;
+        }
+
+        if (record.visible && !running)
+            record.outcome = Outcome::ExitedEarly;
+        else if (now - record.launchTick >= this->m_windowTicks)
+            record.outcome = record.visible ? Outcome::Running : Outcome::NotVisible;
+        if (record.outcome != Outcome::Watching) {
+            record.earlyExits += record.outcome == Outcome::ExitedEarly;
+            this->m_watching--;
+            changed = true;
+        }
+    }
+    return changed;
+}
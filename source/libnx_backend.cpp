@@ -0,0 +1,106 @@
+#include "libnx_backend.hpp"
+
+#include "ipc_stats.hpp"
+#include "sysmodule.hpp"
+
+static constexpr u32 ExosphereApiVersionConfigItem = 65000;
+
+LibnxBackend::~LibnxBackend() {
+    if (this->m_open)
+        fsFsClose(&this->m_fs);
+}
+
+Result LibnxBackend::initialize() {
+    Result rc;
+    if (R_FAILED(rc = smInitialize()))
+        return rc;
+    if (R_FAILED(rc = nifmInitialize(NifmServiceType_Admin)))
+        return rc;
+    if (R_FAILED(rc = ipcCall(IpcCall::FsOpenSdCardFileSystem, fsOpenSdCardFileSystem, &this->m_fs)))
+        return rc;
+    this->m_open = true;
+    return 0;
+}
+
+Result LibnxBackend::scan(ScanArena &arena, ModuleTable &table, ScanState &state, u32 roots) {
+    return scanModules(&this->m_fs, arena, table, state, ScanIndexPath, ScanWorkers, roots);
+}
+
+Result LibnxBackend::listTitles(TitleListing &listing, u32 roots) {
+    return ::listTitles(&this->m_fs, listing, roots);
+}
+
+Result LibnxBackend::scanTitles(const u64 *programIds, u32 count, ScanArena &arena, ModuleTable &table, u32 roots) {
+    return ::scanTitles(&this->m_fs, programIds, count, arena, table, roots);
+}
+
+bool LibnxBackend::fileExists(const char *path) {
+    return ::fileExists(&this->m_fs, path);
+}
+
+Result LibnxBackend::readFile(const char *path, ScanArena &arena, std::string_view &data) {
+    return ::readFile(&this->m_fs, path, arena, data);
+}
+
+Result LibnxBackend::createFile(const char *path) {
+    return ipcCall(IpcCall::FsCreateFile, fsFsCreateFile, &this->m_fs, path, 0, FsCreateOption(0));
+}
+
+Result LibnxBackend::deleteFile(const char *path) {
+    return ipcCall(IpcCall::FsDeleteFile, fsFsDeleteFile, &this->m_fs, path);
+}
+
+Result LibnxBackend::createDirectory(const char *path) {
+    return ipcCall(IpcCall::FsCreateDirectory, fsFsCreateDirectory, &this->m_fs, path);
+}
+
+Result LibnxBackend::copyFile(const char *srcPath, const char *destPath) {
+    return CopyFile(&this->m_fs, srcPath, destPath);
+}
+
+Result LibnxBackend::appendFile(const char *path, std::string_view data, s64 maxSize) {
+    return AppendFile(&this->m_fs, path, data.data(), data.size(), maxSize);
+}
+
+bool LibnxBackend::isRunning(u64 programId) {
+    return isProgramRunning(programId);
+}
+
+Result LibnxBackend::launchProgram(u64 programId) {
+    const NcmProgramLocation programLocation{
+        .program_id = programId,
+        .storageID = NcmStorageId_None,
+    };
+    u64 pid = 0;
+    return ipcCall(IpcCall::PmshellLaunchProgram, pmshellLaunchProgram, 0, &programLocation, &pid);
+}
+
+Result LibnxBackend::terminateProgram(u64 programId) {
+    return ipcCall(IpcCall::PmshellTerminateProgram, pmshellTerminateProgram, programId);
+}
+
+Result LibnxBackend::getMemoryUsage(u64 programId, u64 &usedBytes) {
+    return getProgramMemoryUsage(programId, usedBytes);
+}
+
+Result LibnxBackend::getSystemPoolUsage(u64 &size, u64 &usedBytes) {
+    return ::getSystemPoolUsage(size, usedBytes);
+}
+
+Result LibnxBackend::getExosphereVersion(u64 &version) {
+    Result rc = splInitialize();
+    if (R_FAILED(rc))
+        return rc;
+    rc = ipcCall(IpcCall::SplGetConfig, splGetConfig, static_cast<SplConfigItem>(ExosphereApiVersionConfigItem), &version);
+    splExit();
+    return rc;
+}
+
+Result LibnxBackend::shutdown(bool reboot) {
+    Result rc = spsmInitialize();
+    if (R_FAILED(rc))
+        return rc;
+    rc = ipcCall(IpcCall::SpsmShutdown, spsmShutdown, reboot);
+    spsmExit();
+    return rc;
+}
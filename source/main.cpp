@@ -1,5 +1,6 @@
 #define TESLA_INIT_IMPL
 #include "gui_main.hpp"
+#include "headless.hpp"
 
 class OverlaySysmodules : public tsl::Overlay {
   public:
@@ -19,6 +20,28 @@ class OverlaySysmodules : public tsl::Overlay {
     }
 };
 
+/* Launched with a profile or module to change, e.g. from a hotkey: apply it and exit without showing anything. */
+static int runHeadlessLaunch(int argc, char **argv) {
+    /* The backend opens sm, which the pm services need. */
+    LibnxBackend backend;
+    if (R_FAILED(backend.initialize()) || R_FAILED(pmdmntInitialize()))
+        return 1;
+    if (R_FAILED(pmshellInitialize())) {
+        pmdmntExit();
+        return 1;
+    }
+
+    const u32 failed = runHeadless(backend, argc, argv);
+
+    pmshellExit();
+    pmdmntExit();
+    if (failed == HeadlessUsageError)
+        return 2;
+    return failed == 0 ? 0 : 1;
+}
+
 int main(int argc, char **argv) {
+    if (isHeadlessLaunch(argc, argv))
+        return runHeadlessLaunch(argc, argv);
     return tsl::loop<OverlaySysmodules>(argc, argv);
-}
\ No newline at end of file
+}
@@ -0,0 +1,499 @@
+#include "module_engine.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+constexpr const char *const BootDatPath = "/boot.dat";
+constexpr const char *const SxosBootDatPath = "/bootloader/boot-sxos.dat";
+
+namespace {
+
+    enum class BatchState : u8 {
+        Pending,
+        Done,
+        Failed,
+    };
+
+    constexpr u32 NotInBatch = ~0u;
+
+}
+
+ModuleEngine::ModuleEngine(Backend &backend, u64 sampleIntervalNs, u64 launchWindowNs)
+    : m_backend(backend), m_usage(sampleIntervalNs), m_launches(launchWindowNs) {}
+
+Result ModuleEngine::initialize() {
+    /* A version that can't be read doesn't rule anything out, the modules are scanned with the default boot file. */
+    u64 version = 0;
+    if (R_SUCCEEDED(this->m_backend.getExosphereVersion(version))) {
+        const u32 micro = (version >> 40) & 0xff;
+        const u32 minor = (version >> 48) & 0xff;
+        const u32 major = (version >> 56) & 0xff;
+        if (major == 0 && minor == 0 && micro == 0) {
+            this->m_bootDat = BootDatType::SXOS_BOOT_TYPE;
+            this->m_roots = SxosContentRoots;
+        } else if ((major == 0 && minor >= 9) || major == 1) {
+            this->m_bootDat = BootDatType::SXGEAR_BOOT_TYPE;
+            this->m_roots = AtmosphereContentRoots;
+        } else
+            return MAKERESULT(Module_Libnx, LibnxError_IncompatSysVer);
+    }
+
+    Result rc;
+    if (R_FAILED(rc = this->m_backend.scan(this->m_arena, this->m_modules, this->m_scanState, this->m_roots)))
+        return rc;
+    this->m_search.build(this->m_modules, this->m_arena);
+    this->m_scanned = true;
+    return 0;
+}
+
+bool ModuleEngine::rescan() {
+    /*
+     * Listing the roots costs a timestamp query per title, the modules are only looked at again when titles were
+     * added, removed or had their files changed.
+     */
+    TitleListing listing;
+    if (R_FAILED(this->m_backend.listTitles(listing, this->m_roots)) || listing == this->m_scanState.listing)
+        return false;
+
+    ScanArena arena;
+    ModuleTable modules;
+    ScanState state = this->m_scanState;
+    if (R_FAILED(this->m_backend.scan(arena, modules, state, this->m_roots)))
+        return false;
+
+    /* Only directories without modules changed, the table is the same. */
+    if (!state.changed) {
+        this->m_scanState.listing = state.listing;
+        return false;
+    }
+
+    /* The selected program ids are sorted once, each new module is then a binary search in them. */
+    ScanArena scratch;
+    const u32 selectedCount = this->m_modules.selectedCount();
+    u64 *selected = selectedCount > 0 ? scratch.allocateArray<u64>(selectedCount) : nullptr;
+    if (selected != nullptr) {
+        u32 count = 0;
+        for (u32 old = 0; old < this->m_modules.size() && count < selectedCount; old++) {
+            if (this->m_modules.selected(old))
+                selected[count++] = this->m_modules.programId(old);
+        }
+        std::sort(selected, selected + count);
+        for (u32 module = 0; module < modules.size(); module++) {
+            if (std::binary_search(selected, selected + count, modules.programId(module)))
+                modules.setSelected(module, true);
+        }
+    }
+
+    ModuleSearch search;
+    search.build(modules, arena);
+
+    /* The new state points into the new arena, so everything is swapped at once. */
+    this->m_arena = std::move(arena);
+    this->m_modules = modules;
+    this->m_search = search;
+    this->m_scanState = state;
+    this->m_usage.invalidate();
+    return true;
+}
+
+Result ModuleEngine::loadTitles(const u64 *programIds, u32 count) {
+    ScanArena arena;
+    ModuleTable modules;
+    if (Result rc = this->m_backend.scanTitles(programIds, count, arena, modules, this->m_roots); R_FAILED(rc))
+        return rc;
+
+    ModuleSearch search;
+    search.build(modules, arena);
+    this->m_arena = std::move(arena);
+    this->m_modules = modules;
+    this->m_search = search;
+    this->m_scanState = {};
+    this->m_usage.invalidate();
+    this->m_scanned = true;
+    return 0;
+}
+
+u32 ModuleEngine::find(u64 programId) const {
+    for (u32 module = 0; module < this->m_modules.size(); module++) {
+        if (this->m_modules.programId(module) == programId)
+            return module;
+    }
+    return this->m_modules.size();
+}
+
+void ModuleEngine::updateStatus(u32 module) {
+    const bool running = this->m_backend.isRunning(this->m_modules.programId(module));
+    this->m_modules.setState(module, running, this->m_backend.fileExists(this->m_modules.boot2FlagPath(module)));
+}
+
+bool ModuleEngine::pollLaunches() {
+    if (!this->m_launches.watching())
+        return false;
+
+    /* Records stay where they are while polling, so the ones that finished can be told apart afterwards. */
+    bool watching[LaunchTracker::MaxRecords];
+    for (u32 i = 0; i < this->m_launches.count(); i++)
+        watching[i] = this->m_launches.records()[i].outcome == LaunchTracker::Outcome::Watching;
+    if (!this->m_launches.poll(this->m_backend))
+        return false;
+
+    const u64 now = armGetSystemTick();
+    for (u32 i = 0; i < this->m_launches.count(); i++) {
+        const LaunchTracker::Record &record = this->m_launches.records()[i];
+        if (!watching[i] || record.outcome == LaunchTracker::Outcome::Watching || record.outcome == LaunchTracker::Outcome::Running)
+            continue;
+
+        const bool exited = record.outcome == LaunchTracker::Outcome::ExitedEarly;
+        this->m_journal.record(exited ? JournalAction::ExitedEarly : JournalAction::NotVisible, record.programId, 0, record.launchTick, now);
+        const u32 module = this->find(record.programId);
+        if (module != this->m_modules.size() && this->m_modules.running(module)) {
+            this->m_modules.setRunning(module, false);
+            this->m_usage.invalidate();
+        }
+    }
+    return true;
+}
+
+Result ModuleEngine::toggleRunning(u32 module) {
+    const u64 programId = this->m_modules.programId(module);
+    const char *flagPath = this->m_modules.boot2FlagPath(module);
+    this->m_usage.invalidate();
+
+    if (this->m_backend.isRunning(programId)) {
+        const u64 start = armGetSystemTick();
+        Result rc = this->m_backend.terminateProgram(programId);
+        this->m_journal.record(JournalAction::Stop, programId, rc, start, armGetSystemTick());
+        if (R_SUCCEEDED(rc)) {
+            this->m_modules.setRunning(module, false);
+            this->m_launches.stopped(programId);
+        }
+        if (this->m_backend.fileExists(flagPath))
+            this->setAutoStart(module, false);
+        return rc;
+    }
+
+    Result rc = 0;
+    this->startModules(&module, 1, &rc);
+    if (!this->m_backend.fileExists(flagPath))
+        this->setAutoStart(module, true);
+    return rc;
+}
+
+ModuleEngine::BatchResult ModuleEngine::startModules(const u32 *modules, u32 count, Result *results, u32 workers) {
+    return this->runBatch(modules, count, true, results, workers);
+}
+
+ModuleEngine::BatchResult ModuleEngine::stopModules(const u32 *modules, u32 count, Result *results, u32 workers) {
+    return this->runBatch(modules, count, false, results, workers);
+}
+
+ModuleEngine::BatchResult ModuleEngine::runSelected(bool start) {
+    ScanArena scratch;
+    u32 *selected = scratch.allocateArray<u32>(this->m_modules.selectedCount());
+    if (selected == nullptr)
+        return {};
+
+    u32 count = 0;
+    for (u32 module = 0; module < this->m_modules.size() && count < this->m_modules.selectedCount(); module++) {
+        if (this->m_modules.selected(module))
+            selected[count++] = module;
+    }
+    return this->runBatch(selected, count, start, nullptr, BatchWorkers);
+}
+
+ModuleEngine::BatchResult ModuleEngine::runBatch(const u32 *modules, u32 count, bool start, Result *results, u32 workers) {
+    const u32 size = this->m_modules.size();
+    ScanArena scratch;
+    u32 *memberOf = scratch.allocateArray<u32>(size);
+    u32 *members = scratch.allocateArray<u32>(size);
+    BatchState *states = scratch.allocateArray<BatchState>(size);
+    Result *memberResults = scratch.allocateArray<Result>(size);
+    u32 *ready = scratch.allocateArray<u32>(size);
+    u32 *failing = scratch.allocateArray<u32>(size);
+    u32 *waitCounts = scratch.allocateArray<u32>(size);
+    u32 *waiterBegin = scratch.allocateArray<u32>(size + 1);
+    u64 *startTicks = scratch.allocateArray<u64>(size);
+    u64 *endTicks = scratch.allocateArray<u64>(size);
+    u32 *byProgramId = scratch.allocateArray<u32>(size);
+    if (size == 0 || memberOf == nullptr || members == nullptr || states == nullptr || memberResults == nullptr || ready == nullptr || failing == nullptr ||
+        waitCounts == nullptr || waiterBegin == nullptr || startTicks == nullptr || endTicks == nullptr || byProgramId == nullptr)
+        return { .failed = count };
+    std::fill(memberOf, memberOf + size, NotInBatch);
+
+    /* Dependencies are looked up by program id, sorted once instead of searching the table for each. */
+    const u64 *programIds = this->m_modules.programIds();
+    for (u32 module = 0; module < size; module++)
+        byProgramId[module] = module;
+    std::sort(byProgramId, byProgramId + size, [programIds](u32 lhs, u32 rhs) {
+        return programIds[lhs] < programIds[rhs];
+    });
+    auto lookup = [&](u64 programId) -> u32 {
+        const u32 *found = std::lower_bound(byProgramId, byProgramId + size, programId, [programIds](u32 module, u64 programId) {
+            return programIds[module] < programId;
+        });
+        return found != byProgramId + size && programIds[*found] == programId ? *found : size;
+    };
+
+    u32 memberCount = 0;
+    auto add = [&](u32 module) {
+        if (memberOf[module] == NotInBatch) {
+            memberOf[module] = memberCount;
+            members[memberCount++] = module;
+        }
+    };
+    for (u32 i = 0; i < count; i++)
+        add(modules[i]);
+
+    /* Starting a module brings up what it depends on, the list grows while it's walked. Stopping only stops what was asked for. */
+    u32 dependencyCount = 0;
+    for (u32 i = 0; i < memberCount; i++) {
+        const u32 module = members[i];
+        memberResults[i] = 0;
+        startTicks[i] = 0;
+        waitCounts[i] = 0;
+        states[i] = this->m_backend.isRunning(this->m_modules.programId(module)) == start ? BatchState::Done : BatchState::Pending;
+        if (states[i] == BatchState::Done)
+            continue;
+        if (this->m_modules.needReboot(module)) {
+            states[i] = BatchState::Failed;
+            memberResults[i] = ResultModuleNeedsReboot;
+            continue;
+        }
+
+        /* Checked before any of them is added, a module that won't be started doesn't bring up its other dependencies. */
+        if (start) {
+            for (u64 dependency : this->m_modules.dependencies(module)) {
+                /* Not something the overlay knows how to start, it has to be running already. */
+                if (lookup(dependency) == size && !this->m_backend.isRunning(dependency)) {
+                    states[i] = BatchState::Failed;
+                    memberResults[i] = ResultDependencyNotRunning;
+                    break;
+                }
+            }
+            if (states[i] == BatchState::Failed)
+                continue;
+        }
+
+        for (u64 dependency : this->m_modules.dependencies(module)) {
+            const u32 found = lookup(dependency);
+            if (found != size) {
+                if (start)
+                    add(found);
+                dependencyCount++;
+            }
+        }
+    }
+
+    /*
+     * Who waits on whom, as member indices grouped by the member waited on. Starting, a module waits
+     * for its dependencies, stopping, a dependency waits for the modules that depend on it. Only
+     * pending members wait. Starting, they also wait on members that already failed, which fails them.
+     */
+    u32 *waiters = scratch.allocateArray<u32>(dependencyCount);
+    if (dependencyCount > 0 && waiters == nullptr)
+        return { .failed = count };
+    std::fill(waiterBegin, waiterBegin + memberCount + 1, 0);
+    auto forEachEdge = [&](auto &&function) {
+        for (u32 i = 0; i < memberCount; i++) {
+            if (states[i] != BatchState::Pending)
+                continue;
+            for (u64 dependency : this->m_modules.dependencies(members[i])) {
+                const u32 found = lookup(dependency);
+                if (found == size || memberOf[found] == NotInBatch)
+                    continue;
+                const u32 member = memberOf[found];
+                if (start && states[member] != BatchState::Done)
+                    function(member, i);
+                else if (!start && states[member] == BatchState::Pending)
+                    function(i, member);
+            }
+        }
+    };
+    std::fill(failing, failing + memberCount, 0);
+    forEachEdge([&](u32 waitedOn, u32 waiter) {
+        waiterBegin[waitedOn + 1]++;
+        waitCounts[waiter]++;
+    });
+    for (u32 i = 0; i < memberCount; i++)
+        waiterBegin[i + 1] += waiterBegin[i];
+    forEachEdge([&](u32 waitedOn, u32 waiter) {
+        /* failing is free until the batch runs, it tracks where each group is filled up to. */
+        waiters[waiterBegin[waitedOn] + failing[waitedOn]++] = waiter;
+    });
+
+    /*
+     * Queues whatever a finished member held back. A failed start fails everything waiting on it,
+     * and in turn what waits on those, without a call.
+     */
+    u32 readyBegin = 0, readyEnd = 0;
+    auto finish = [&](u32 member) {
+        u32 failingCount = 0;
+        failing[failingCount++] = member;
+        while (failingCount > 0) {
+            const u32 finished = failing[--failingCount];
+            for (u32 w = waiterBegin[finished]; w < waiterBegin[finished + 1]; w++) {
+                const u32 waiter = waiters[w];
+                if (states[waiter] != BatchState::Pending || waitCounts[waiter] == 0)
+                    continue;
+                if (start && states[finished] == BatchState::Failed) {
+                    states[waiter] = BatchState::Failed;
+                    memberResults[waiter] = ResultDependencyNotRunning;
+                    failing[failingCount++] = waiter;
+                } else if (--waitCounts[waiter] == 0) {
+                    ready[readyEnd++] = waiter;
+                }
+            }
+        }
+    };
+    u32 pendingCount = 0;
+    for (u32 i = 0; i < memberCount; i++) {
+        pendingCount += states[i] == BatchState::Pending;
+        if (states[i] == BatchState::Pending && waitCounts[i] == 0)
+            ready[readyEnd++] = i;
+    }
+    for (u32 i = 0; i < memberCount; i++) {
+        if (states[i] == BatchState::Failed)
+            finish(i);
+    }
+
+    /* Every worker takes the next ready member, so a module is dispatched as soon as the last call it waited on returned. */
+    BatchResult result;
+    Mutex mutex;
+    CondVar condvar;
+    mutexInit(&mutex);
+    condvarInit(&condvar);
+    u32 inFlight = 0;
+    auto dispatch = [&](u32 worker, u32 index) {
+        mutexLock(&mutex);
+        while (true) {
+            if (readyBegin == readyEnd) {
+                if (inFlight > 0) {
+                    condvarWait(&condvar, &mutex);
+                    continue;
+                }
+
+                /* What's left depends on itself. Cycles aren't started, but stopping them in any order is fine. */
+                for (u32 i = 0; i < memberCount; i++) {
+                    if (states[i] != BatchState::Pending)
+                        continue;
+                    if (start) {
+                        states[i] = BatchState::Failed;
+                        memberResults[i] = ResultDependencyCycle;
+                    } else {
+                        waitCounts[i] = 0;
+                        ready[readyEnd++] = i;
+                    }
+                }
+                if (readyBegin == readyEnd)
+                    break;
+            }
+
+            const u32 member = ready[readyBegin++];
+            const u64 programId = this->m_modules.programId(members[member]);
+            inFlight++;
+            mutexUnlock(&mutex);
+            const u64 startTick = armGetSystemTick();
+            const Result rc = start ? this->m_backend.launchProgram(programId) : this->m_backend.terminateProgram(programId);
+            const u64 endTick = armGetSystemTick();
+            mutexLock(&mutex);
+            inFlight--;
+
+            startTicks[member] = startTick;
+            endTicks[member] = endTick;
+            memberResults[member] = rc;
+            states[member] = R_SUCCEEDED(rc) ? BatchState::Done : BatchState::Failed;
+            result.changed += R_SUCCEEDED(rc);
+            this->m_journal.record(start ? JournalAction::Start : JournalAction::Stop, programId, rc, startTick, endTick);
+            if (start && R_SUCCEEDED(rc))
+                this->m_launches.launched(programId, startTick);
+            else if (R_SUCCEEDED(rc))
+                this->m_launches.stopped(programId);
+            finish(member);
+            condvarWakeAll(&condvar);
+        }
+        condvarWakeAll(&condvar);
+        mutexUnlock(&mutex);
+    };
+    WorkPool(workers).run(std::min(workers, pendingCount), dispatch);
+
+    /* Most processes are up by the time their launch returns, this gets their latency without waiting for a frame. */
+    if (start)
+        this->pollLaunches();
+
+    const u64 now = armGetSystemTick();
+    for (u32 i = 0; i < memberCount; i++) {
+        /* Modules the batch gave up on without a call are journaled with the reason. */
+        if (states[i] == BatchState::Failed && startTicks[i] == 0)
+            this->m_journal.record(start ? JournalAction::Start : JournalAction::Stop, this->m_modules.programId(members[i]), memberResults[i], now, now);
+        result.failed += states[i] == BatchState::Failed;
+        if (states[i] == BatchState::Done)
+            this->m_modules.setRunning(members[i], start);
+    }
+    if (results != nullptr) {
+        for (u32 i = 0; i < count; i++)
+            results[i] = memberResults[memberOf[modules[i]]];
+    }
+    if (result.changed > 0)
+        this->m_usage.invalidate();
+    return result;
+}
+
+Result ModuleEngine::toggleAutoStart(u32 module) {
+    return this->setAutoStart(module, !this->m_backend.fileExists(this->m_modules.boot2FlagPath(module)));
+}
+
+Result ModuleEngine::setAutoStart(u32 module, bool enabled) {
+    const char *flagPath = this->m_modules.boot2FlagPath(module);
+    const u64 start = armGetSystemTick();
+    Result rc;
+    if (enabled) {
+        this->createFlagsDirectory(module);
+        rc = this->m_backend.createFile(flagPath);
+    } else {
+        rc = this->m_backend.deleteFile(flagPath);
+    }
+    this->m_journal.record(enabled ? JournalAction::CreateFlag : JournalAction::DeleteFlag, this->m_modules.programId(module), rc, start, armGetSystemTick());
+    if (R_SUCCEEDED(rc))
+        this->m_modules.setHasFlag(module, enabled);
+    return rc;
+}
+
+void ModuleEngine::createFlagsDirectory(u32 module) {
+    /* if the folder "flags" does not exist, it will be created */
+    char flagsDirectory[FS_MAX_PATH];
+    const size_t flagsDirectoryLength = this->m_modules.flagsDirectoryLength(module);
+    std::memcpy(flagsDirectory, this->m_modules.boot2FlagPath(module), flagsDirectoryLength);
+    flagsDirectory[flagsDirectoryLength] = '\0';
+    this->m_backend.createDirectory(flagsDirectory);
+}
+
+void ModuleEngine::toggleSelected(u32 module) {
+    /* The estimate follows from the cached samples, nothing is queried for it. */
+    this->m_modules.setSelected(module, !this->m_modules.selected(module));
+}
+
+Result ModuleEngine::selectBootDat(BootDatType type) {
+    if (type == this->m_bootDat)
+        return 0;
+    /* Only SXOS keeps its boot.dat around to switch to. */
+    if (type != BootDatType::SXOS_BOOT_TYPE)
+        return MAKERESULT(Module_Libnx, LibnxError_NotFound);
+
+    const u64 start = armGetSystemTick();
+    Result rc = this->m_backend.copyFile(SxosBootDatPath, BootDatPath);
+    this->m_journal.record(JournalAction::SelectBootDat, 0, rc, start, armGetSystemTick());
+    if (R_FAILED(rc))
+        return rc;
+    this->m_bootDat = type;
+    return 0;
+}
+
+Result ModuleEngine::flushJournal() {
+    if (this->m_journal.unflushed() == 0)
+        return 0;
+
+    /* Both may exist already, the scan index lives in the same directory. */
+    this->m_backend.createDirectory("/config");
+    this->m_backend.createDirectory("/config/ovlSysmodules");
+    return this->m_journal.flush(this->m_backend, JournalPath);
+}
@@ -0,0 +1,373 @@
+#include "module_scanner.hpp"
+
+#include "dir_iterator.hpp"
+#include "exefs.hpp"
+#include "ipc_stats.hpp"
+#include "program_id.hpp"
+#include "sysmodule.hpp"
+#include "toolbox.hpp"
+#include "work_pool.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+/* Fewer titles to read than this are read on the calling thread, starting the workers would take longer. */
+constexpr u32 MinParallelProbes = 8;
+
+constexpr const char *const titleFileFormat = "%s/%.*s/%s";
+
+constexpr const char *const sourceFiles[] = {
+    [u32(ModuleSource::None)] = "",
+    [u32(ModuleSource::Toolbox)] = "toolbox.json",
+    [u32(ModuleSource::ExefsNsp)] = "exefs.nsp",
+    [u32(ModuleSource::ExefsNpdm)] = "exefs/main.npdm",
+};
+
+namespace {
+
+    /* A title directory found while listing the roots. Kept small, the listing is held while the directories are open. */
+    struct ListedTitle {
+        ListedTitle *next;
+        u64 programId;
+        char directory[ProgramIdLength];
+        u8 root;
+    };
+
+    /* A listed title, filled in by whichever worker looks into it. */
+    struct Title {
+        u64 programId;
+        char directory[ProgramIdLength];
+        u8 root;
+        ModuleSource source;
+        u8 flags;
+        bool reused;
+        u64 modified;
+        /* What the title adds to the listing, see TitleListing::add(). */
+        ModuleSource listedSource;
+        u64 listedModified;
+        std::string_view name;
+        std::span<const u64> dependencies;
+    };
+
+    void formatTitlePath(char *path, const ContentRoot &root, std::string_view titleDir, ModuleSource source) {
+        std::snprintf(path, FS_MAX_PATH, titleFileFormat, root.path, int(titleDir.size()), titleDir.data(), sourceFiles[u32(source)]);
+    }
+
+    /* Copies dependencies into arena, an empty span if there are none or it's out of memory. */
+    std::span<const u64> copyDependencies(ScanArena &arena, const u64 *dependencies, u32 count) {
+        u64 *copy = count > 0 ? arena.allocateArray<u64>(count) : nullptr;
+        if (copy == nullptr)
+            return {};
+        std::memcpy(copy, dependencies, count * sizeof(u64));
+        return std::span<const u64>(copy, count);
+    }
+
+    /* Tries the places a module can be described in, in order of preference. The name and dependencies are allocated from arena. */
+    ModuleSource probeModule(FsFileSystem *fs, const ContentRoot &root, std::string_view titleDir, u64 programId, ScanArena &arena, std::string_view &name, u8 &flags,
+                             std::span<const u64> &dependencies) {
+        char path[FS_MAX_PATH];
+        formatTitlePath(path, root, titleDir, ModuleSource::Toolbox);
+
+        ScanArena::Marker marker = arena.mark();
+        std::string_view data;
+        ToolboxInfo toolbox;
+        if (R_SUCCEEDED(readFile(fs, path, arena, data)) && parseToolbox(data, toolbox) && toolbox.programId == programId) {
+            /* Decode the name to the front of the file buffer and give the rest of the buffer back. */
+            char *buffer = const_cast<char *>(data.data());
+            size_t length = unescapeJsonString(toolbox.rawName, buffer);
+            arena.shrink(buffer, length);
+
+            name = std::string_view(buffer, length);
+            flags = toolbox.needReboot ? ModuleTable::Flag_NeedReboot : 0;
+            dependencies = copyDependencies(arena, toolbox.dependencies, toolbox.dependencyCount);
+            return ModuleSource::Toolbox;
+        }
+        arena.rewind(marker);
+
+        /* Atmosphère prefers exefs.nsp over an exefs directory, so do we. */
+        char npdmName[NpdmNameLength];
+        size_t length = 0;
+        ModuleSource source = ModuleSource::ExefsNsp;
+        formatTitlePath(path, root, titleDir, source);
+        if (R_FAILED(readNspNpdmName(fs, path, npdmName, length))) {
+            source = ModuleSource::ExefsNpdm;
+            formatTitlePath(path, root, titleDir, source);
+            if (R_FAILED(readNpdmName(fs, path, npdmName, length)))
+                return ModuleSource::None;
+        }
+
+        name = arena.copy(std::string_view(npdmName, length));
+        if (name.empty())
+            return ModuleSource::None;
+        flags = ModuleTable::Flag_NeedReboot | ModuleTable::Flag_NoToolbox;
+        return source;
+    }
+
+    /* Whether a file probeModule() prefers over source exists, one added since the title was indexed would describe it instead. */
+    bool hasPreferredSource(FsFileSystem *fs, const ContentRoot &root, std::string_view titleDir, ModuleSource source) {
+        char path[FS_MAX_PATH];
+        u64 modified;
+        for (u32 preferred = u32(ModuleSource::Toolbox); preferred < u32(source); preferred++) {
+            formatTitlePath(path, root, titleDir, ModuleSource(preferred));
+            if (R_SUCCEEDED(getModificationTime(fs, path, modified)))
+                return true;
+        }
+        return false;
+    }
+
+    /* The first file a title could be described by that exists, and its modification time. None if there's none of them. */
+    ModuleSource findListedSource(FsFileSystem *fs, const ContentRoot &root, std::string_view titleDir, u64 &modified) {
+        char path[FS_MAX_PATH];
+        for (u32 source = u32(ModuleSource::Toolbox); source <= u32(ModuleSource::ExefsNpdm); source++) {
+            formatTitlePath(path, root, titleDir, ModuleSource(source));
+            if (R_SUCCEEDED(getModificationTime(fs, path, modified)))
+                return ModuleSource(source);
+        }
+        modified = 0;
+        return ModuleSource::None;
+    }
+
+    /*
+     * Takes a title from the index if its file is unchanged and no file it's preferred to was added. Returns false if it has to be probed.
+     * Names taken from an index that doesn't live in arena are copied into it.
+     */
+    bool reuseTitle(FsFileSystem *fs, const ScanIndex &index, bool copyReused, Title &title, ScanArena &arena) {
+        const ContentRoot &root = ContentRoots[title.root];
+        const std::string_view titleDir(title.directory, ProgramIdLength);
+        char path[FS_MAX_PATH];
+
+        const ScanIndex::Entry *cached = index.find(title.root, title.programId);
+        if (cached == nullptr)
+            return false;
+        formatTitlePath(path, root, titleDir, cached->source);
+        if (R_FAILED(getModificationTime(fs, path, title.modified)) || title.modified == 0 || title.modified != cached->modified ||
+            hasPreferredSource(fs, root, titleDir, cached->source))
+            return false;
+
+        title.source = cached->source;
+        title.name = copyReused ? arena.copy(index.name(*cached)) : index.name(*cached);
+        title.flags = cached->flags;
+        title.reused = true;
+        /* Nothing preferred exists and the file is unchanged, so that's what the listing finds too. */
+        title.listedSource = cached->source;
+        title.listedModified = title.modified;
+        if (cached->dependencyCount > 0) {
+            u64 dependencies[MaxDependencies];
+            index.dependencies(*cached, dependencies);
+            title.dependencies = copyDependencies(arena, dependencies, cached->dependencyCount);
+        }
+        return true;
+    }
+
+    /* Reads the files of a title the index couldn't vouch for. Leaves source at None if it isn't a module. */
+    void probeTitle(FsFileSystem *fs, bool indexed, Title &title, ScanArena &arena) {
+        const ContentRoot &root = ContentRoots[title.root];
+        const std::string_view titleDir(title.directory, ProgramIdLength);
+        char path[FS_MAX_PATH];
+
+        title.listedSource = findListedSource(fs, root, titleDir, title.listedModified);
+        title.source = probeModule(fs, root, titleDir, title.programId, arena, title.name, title.flags, title.dependencies);
+        if (title.source == ModuleSource::None)
+            return;
+
+        formatTitlePath(path, root, titleDir, title.source);
+        if (!indexed || R_FAILED(getModificationTime(fs, path, title.modified)))
+            title.modified = 0;
+    }
+
+    /*
+     * Calls onTitle(root, programId, name) for every directory in roots named after a program id, until it returns
+     * false. Roots that don't exist are skipped, this only fails if none of them could be opened.
+     */
+    template <typename F>
+    Result listTitleDirectories(FsFileSystem *fs, u32 roots, F &&onTitle) {
+        Result openResult = 0;
+        u32 rootsOpened = 0;
+        bool stopped = false;
+        for (u8 rootIndex = 0; rootIndex < ContentRootCount && !stopped; rootIndex++) {
+            if ((roots & (1u << rootIndex)) == 0)
+                continue;
+            FsDir contentDir;
+            if (Result result = ipcCall(IpcCall::FsOpenDirectory, fsFsOpenDirectory, fs, ContentRoots[rootIndex].path, FsDirOpenMode_ReadDirs, &contentDir); R_FAILED(result)) {
+                if (R_SUCCEEDED(openResult))
+                    openResult = result;
+                continue;
+            }
+            rootsOpened++;
+
+            /* Iterate over contents folder. */
+            for (const auto &entry : FsDirIterator(contentDir)) {
+                /* Directories that aren't named after a program id can't hold a sysmodule, don't touch their files. */
+                u64 programId;
+                if (!parseProgramId(entry.name, programId) || programId == TeslaProgramId)
+                    continue;
+                if (!onTitle(rootIndex, programId, entry.name)) {
+                    stopped = true;
+                    break;
+                }
+            }
+            ipcCall(IpcCall::FsDirClose, fsDirClose, &contentDir);
+        }
+        return rootsOpened > 0 ? 0 : openResult;
+    }
+
+    Result scan(FsFileSystem *fs, ScanArena &arena, ModuleTable &table, const char *indexPath, u32 workers, u32 roots, ScanState &state, bool keepState) {
+        /* A missing or broken index just means every module is probed. */
+        const bool copyReused = state.valid;
+        if (!state.valid && indexPath != nullptr)
+            state.index.load(fs, indexPath, arena);
+        const bool indexed = keepState || indexPath != nullptr;
+
+        /* Title directories are listed first, in directory order, and only looked into afterwards. */
+        ScanArena scratch;
+        ListedTitle *listed = nullptr, **tail = &listed;
+        u32 titleCount = 0;
+
+        Result rc = 0;
+        if (Result listResult = listTitleDirectories(fs, roots, [&](u8 root, u64 programId, const char *name) {
+                ListedTitle *title = scratch.allocateArray<ListedTitle>(1);
+                if (title == nullptr) {
+                    rc = MAKERESULT(Module_Libnx, LibnxError_OutOfMemory);
+                    return false;
+                }
+                *title = ListedTitle{ .next = nullptr, .programId = programId, .root = root };
+                std::memcpy(title->directory, name, ProgramIdLength);
+                *tail = title;
+                tail = &title->next;
+                titleCount++;
+                return true;
+            }); R_FAILED(listResult))
+            return listResult;
+
+        Title *titles = scratch.allocateArray<Title>(titleCount);
+        if (R_SUCCEEDED(rc) && titles == nullptr && titleCount > 0)
+            rc = MAKERESULT(Module_Libnx, LibnxError_OutOfMemory);
+
+        Title **probes = scratch.allocateArray<Title *>(titleCount);
+        if (R_SUCCEEDED(rc) && probes == nullptr && titleCount > 0)
+            rc = MAKERESULT(Module_Libnx, LibnxError_OutOfMemory);
+
+        if (R_SUCCEEDED(rc)) {
+            /*
+             * Checking a title against the index is one timestamp query, which
+             * isn't worth a thread. Only the titles left to be read are spread
+             * over the workers, and only if there are enough of them to make up
+             * for starting the threads.
+             */
+            u32 i = 0, probeCount = 0;
+            for (const ListedTitle *entry = listed; entry != nullptr; entry = entry->next, i++) {
+                Title &title = titles[i];
+                title = Title{ .programId = entry->programId, .root = entry->root, .source = ModuleSource::None };
+                std::memcpy(title.directory, entry->directory, ProgramIdLength);
+                if (!reuseTitle(fs, state.index, copyReused, title, arena))
+                    probes[probeCount++] = &title;
+            }
+
+            /* Every worker allocates from its own arena, they all end up in the table's. */
+            ScanArena workerArenas[WorkPool::MaxWorkers - 1];
+            auto probe = [&](u32 worker, u32 i) {
+                probeTitle(fs, indexed, *probes[i], worker == 0 ? arena : workerArenas[worker - 1]);
+            };
+            WorkPool(probeCount < MinParallelProbes ? 1 : workers).run(probeCount, probe);
+            for (auto &workerArena : workerArenas)
+                arena.adopt(workerArena);
+        }
+
+        /* Added in listing order, so the table doesn't depend on which worker finished first. */
+        ModuleTable::Builder builder(arena);
+        ScanIndex::Writer indexWriter;
+        TitleListing listing;
+        u32 reused = 0;
+        bool changed = false;
+        for (u32 i = 0; i < titleCount && R_SUCCEEDED(rc); i++) {
+            const Title &title = titles[i];
+            listing.add(title.root, title.programId, title.listedSource, title.listedModified);
+            if (title.source == ModuleSource::None)
+                continue;
+
+            reused += title.reused;
+            changed |= !title.reused;
+            if (!builder.add(title.programId, title.root, title.name, title.flags, title.dependencies) ||
+                (indexed && !indexWriter.add(title.programId, title.root, title.modified, title.source, title.flags, title.name, title.dependencies)))
+                rc = MAKERESULT(Module_Libnx, LibnxError_OutOfMemory);
+        }
+
+        if (R_SUCCEEDED(rc) && !builder.build(table))
+            rc = MAKERESULT(Module_Libnx, LibnxError_OutOfMemory);
+        if (R_FAILED(rc))
+            return rc;
+
+        changed |= reused != state.index.size();
+        if (keepState) {
+            ScanIndex index;
+            if (!indexWriter.build(arena, index))
+                return MAKERESULT(Module_Libnx, LibnxError_OutOfMemory);
+            state = { .index = index, .listing = listing, .valid = true, .changed = changed };
+        }
+
+        /* Only written when something changed, failing to write it doesn't fail the scan. */
+        if (indexPath != nullptr && changed)
+            indexWriter.save(fs, indexPath);
+        return 0;
+    }
+
+}
+
+void TitleListing::add(u8 root, u64 programId, ModuleSource source, u64 modified) {
+    auto mix = [](u64 z) {
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    };
+    /* Summed, so the order the roots list their directories in doesn't matter. */
+    this->hash += mix(mix(programId + (root + 1) * 0x9E3779B97F4A7C15ULL) + modified * 4 + u64(source));
+    this->count++;
+}
+
+Result scanTitles(FsFileSystem *fs, const u64 *programIds, u32 count, ScanArena &arena, ModuleTable &table, u32 roots) {
+    ModuleTable::Builder builder(arena);
+    for (u32 i = 0; i < count; i++) {
+        if (programIds[i] == TeslaProgramId)
+            continue;
+
+        char titleDir[ProgramIdLength];
+        formatProgramId(programIds[i], titleDir);
+        for (u8 root = 0; root < ContentRootCount; root++) {
+            if ((roots & (1u << root)) == 0)
+                continue;
+            std::string_view name;
+            std::span<const u64> dependencies;
+            u8 flags = 0;
+            if (probeModule(fs, ContentRoots[root], std::string_view(titleDir, ProgramIdLength), programIds[i], arena, name, flags, dependencies) == ModuleSource::None)
+                continue;
+            if (!builder.add(programIds[i], root, name, flags, dependencies))
+                return MAKERESULT(Module_Libnx, LibnxError_OutOfMemory);
+            break;
+        }
+    }
+    return builder.build(table) ? 0 : MAKERESULT(Module_Libnx, LibnxError_OutOfMemory);
+}
+
+Result listTitles(FsFileSystem *fs, TitleListing &listing, u32 roots) {
+    listing = {};
+    return listTitleDirectories(fs, roots, [fs, &listing](u8 root, u64 programId, const char *name) {
+        u64 modified;
+        const ModuleSource source = findListedSource(fs, ContentRoots[root], std::string_view(name, ProgramIdLength), modified);
+        listing.add(root, programId, source, modified);
+        return true;
+    });
+}
+
+Result scanModules(FsFileSystem *fs, ScanArena &arena, ModuleTable &table, const char *indexPath, u32 workers, u32 roots) {
+    ScanState state;
+    return scan(fs, arena, table, indexPath, workers, roots, state, false);
+}
+
+Result scanModules(FsFileSystem *fs, ScanArena &arena, ModuleTable &table, ScanState &state, const char *indexPath, u32 workers, u32 roots) {
+    /* Only replaced once the scan succeeded, so a failed rescan can be retried from the same state. */
+    ScanState next = state;
+    Result rc = scan(fs, arena, table, indexPath, workers, roots, next, true);
+    if (R_SUCCEEDED(rc))
+        state = next;
+    return rc;
+}
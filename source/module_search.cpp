@@ -0,0 +1,115 @@
+#include "module_search.hpp"
+
+#include "program_id.hpp"
+
+#include <algorithm>
+
+namespace {
+
+    char toLower(char c) {
+        return c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c;
+    }
+
+    bool isWordChar(char c) {
+        return (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9');
+    }
+
+}
+
+bool ModuleSearch::build(const ModuleTable &table, ScanArena &arena) {
+    this->m_keys = nullptr;
+    this->m_count = 0;
+
+    /* Lowercase copies of the names first, every word key is a suffix of one. */
+    size_t namesSize = 0, keyCount = 0;
+    for (u32 module = 0; module < table.size(); module++)
+        namesSize += table.name(module).size();
+    char *names = static_cast<char *>(arena.allocate(std::max<size_t>(namesSize, 1), 1));
+    char *programIds = static_cast<char *>(arena.allocate(std::max<size_t>(table.size() * ProgramIdLength, 1), 1));
+    if (names == nullptr || programIds == nullptr)
+        return false;
+
+    char *name = names;
+    for (u32 module = 0; module < table.size(); module++) {
+        const std::string_view original = table.name(module);
+        for (size_t i = 0; i < original.size(); i++) {
+            name[i] = toLower(original[i]);
+            keyCount += i == 0 || (isWordChar(name[i]) && !isWordChar(name[i - 1]));
+        }
+        name += original.size();
+        keyCount++;
+    }
+
+    Key *keys = arena.allocateArray<Key>(keyCount);
+    if (keyCount > 0 && keys == nullptr)
+        return false;
+
+    u32 count = 0;
+    name = names;
+    for (u32 module = 0; module < table.size(); module++) {
+        const size_t length = table.name(module).size();
+        for (size_t i = 0; i < length; i++) {
+            if (i == 0 || (isWordChar(name[i]) && !isWordChar(name[i - 1])))
+                keys[count++] = { std::string_view(name + i, length - i), module, 0 };
+        }
+        name += length;
+
+        char *programId = programIds + module * ProgramIdLength;
+        formatProgramId(table.programId(module), programId);
+        for (u32 i = 0; i < ProgramIdLength; i++)
+            programId[i] = toLower(programId[i]);
+        keys[count++] = { std::string_view(programId, ProgramIdLength), module, 0 };
+    }
+
+    std::sort(keys, keys + count, [](const Key &lhs, const Key &rhs) {
+        return lhs.text < rhs.text;
+    });
+
+    /*
+     * Keys sharing a prefix are next to each other, so of a module's keys the
+     * previous one shares the longest prefix with each. Only needed while
+     * building, the scratch arena is dropped afterwards.
+     */
+    ScanArena scratch;
+    u32 *previous = scratch.allocateArray<u32>(std::max<size_t>(table.size(), 1));
+    if (previous == nullptr)
+        return false;
+    std::fill(previous, previous + table.size(), count);
+    for (u32 i = 0; i < count; i++) {
+        Key &key = keys[i];
+        if (previous[key.module] != count) {
+            const std::string_view other = keys[previous[key.module]].text;
+            const size_t length = std::min({ key.text.size(), other.size(), size_t(MaxSearchLength) });
+            while (key.shared < length && key.text[key.shared] == other[key.shared])
+                key.shared++;
+        }
+        previous[key.module] = i;
+    }
+
+    this->m_keys = keys;
+    this->m_count = count;
+    return true;
+}
+
+u32 ModuleSearch::find(std::string_view prefix, u32 *modules, u32 capacity) const {
+    char lowered[MaxSearchLength];
+    const size_t length = std::min<size_t>(prefix.size(), MaxSearchLength);
+    if (length == 0)
+        return 0;
+    for (size_t i = 0; i < length; i++)
+        lowered[i] = toLower(prefix[i]);
+    const std::string_view query(lowered, length);
+
+    /* Keys starting with the query sort right after it, up to the first one that doesn't. */
+    const Key *end = this->m_keys + this->m_count;
+    const Key *first = std::lower_bound(this->m_keys, end, query, [](const Key &key, std::string_view query) {
+        return key.text < query;
+    });
+    /* A module can match through its name, a word and its id at once, only its first key in the range counts. */
+    u32 count = 0;
+    for (const Key *key = first; key != end && count < capacity && key->text.starts_with(query); key++) {
+        if (key->shared < length)
+            modules[count++] = key->module;
+    }
+    return count;
+}
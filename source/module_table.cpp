@@ -0,0 +1,174 @@
+#include "module_table.hpp"
+
+#include "program_id.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+    /* Length of "<root>/<program id>/" */
+    size_t titleDirectoryLength(const ContentRoot &root) {
+        return std::strlen(root.path) + 1 + ProgramIdLength + 1;
+    }
+
+    size_t boot2FlagPathSize(const ContentRoot &root) {
+        return titleDirectoryLength(root) + std::strlen(root.boot2Flag) + 1;
+    }
+
+    char *append(char *out, const char *str) {
+        size_t length = std::strlen(str);
+        std::memcpy(out, str, length);
+        return out + length;
+    }
+
+}
+
+size_t ModuleTable::flagsDirectoryLength(u32 index) const {
+    const ContentRoot &root = this->root(index);
+    return titleDirectoryLength(root) + std::strlen(root.flagsDirectory);
+}
+
+bool ModuleTable::Builder::add(u64 programId, u8 root, std::string_view name, u8 flags, std::span<const u64> dependencies) {
+    auto *record = this->m_records.allocateArray<Record>(1);
+    if (record == nullptr)
+        return false;
+
+    *record = { nullptr, programId, name, dependencies, root, flags, false };
+    if (this->m_tail != nullptr)
+        this->m_tail->next = record;
+    else
+        this->m_head = record;
+    this->m_tail = record;
+    this->m_count++;
+    return true;
+}
+
+void ModuleTable::setSelected(u32 index, bool selected) {
+    if (this->selected(index) == selected)
+        return;
+
+    if (selected) {
+        this->m_state[index] |= State_Selected;
+        this->m_selectedMemoryKiB += this->countedMemoryKiB(index);
+        this->m_selectedCount++;
+    } else {
+        this->m_state[index] &= ~State_Selected;
+        this->m_selectedMemoryKiB -= this->countedMemoryKiB(index);
+        this->m_selectedCount--;
+    }
+}
+
+void ModuleTable::setMemoryUsage(u32 index, u64 bytes) {
+    const u32 counted = this->countedMemoryKiB(index);
+    this->m_memoryKiB[index] = bytes != UnknownMemoryUsage ? std::min<u64>((bytes + 1023) / 1024, UnknownMemoryKiB - 1) : UnknownMemoryKiB;
+    this->m_totalMemoryKiB = this->m_totalMemoryKiB - counted + this->countedMemoryKiB(index);
+    if (this->selected(index))
+        this->m_selectedMemoryKiB = this->m_selectedMemoryKiB - counted + this->countedMemoryKiB(index);
+}
+
+bool ModuleTable::Builder::build(ModuleTable &table) {
+    table = {};
+
+    /* Sorting by id and then by order of addition puts the record to keep first among its duplicates. */
+    struct Key {
+        u64 programId;
+        Record *record;
+        u32 order;
+    };
+    Key *keys = this->m_records.allocateArray<Key>(this->m_count);
+    if (this->m_count > 0 && keys == nullptr)
+        return false;
+
+    u32 order = 0;
+    for (Record *record = this->m_head; record != nullptr; record = record->next, order++)
+        keys[order] = { record->programId, record, order };
+    std::sort(keys, keys + this->m_count, [](const Key &lhs, const Key &rhs) {
+        return lhs.programId != rhs.programId ? lhs.programId < rhs.programId : lhs.order < rhs.order;
+    });
+
+    u32 count = 0, dynamicCount = 0, dependencyCount = 0;
+    for (u32 i = 0; i < this->m_count; i++) {
+        if (i > 0 && keys[i].programId == keys[i - 1].programId) {
+            keys[i].record->hidden = true;
+            continue;
+        }
+        count++;
+        dependencyCount += keys[i].record->dependencies.size();
+        if (!(keys[i].record->flags & Flag_NeedReboot))
+            dynamicCount++;
+    }
+
+    table.m_programIds = this->m_arena.allocateArray<u64>(count);
+    table.m_flags = this->m_arena.allocateArray<u8>(count);
+    table.m_roots = this->m_arena.allocateArray<u8>(count);
+    table.m_state = this->m_arena.allocateArray<u8>(count);
+    table.m_memoryKiB = this->m_arena.allocateArray<u32>(count);
+    table.m_names = this->m_arena.allocateArray<std::string_view>(count);
+    table.m_pathOffsets = this->m_arena.allocateArray<u32>(count);
+    table.m_dependencies = this->m_arena.allocateArray<u64>(dependencyCount);
+    table.m_dependencyOffsets = this->m_arena.allocateArray<u32>(count + 1);
+    Record **placed = this->m_records.allocateArray<Record *>(count);
+
+    size_t pathSizes[ContentRootCount], pathsSize = 0;
+    for (u8 root = 0; root < ContentRootCount; root++)
+        pathSizes[root] = boot2FlagPathSize(ContentRoots[root]);
+    for (u32 i = 0; i < this->m_count; i++) {
+        if (!keys[i].record->hidden)
+            pathsSize += pathSizes[keys[i].record->root];
+    }
+    table.m_paths = static_cast<char *>(this->m_arena.allocate(pathsSize, 1));
+
+    if (table.m_dependencyOffsets == nullptr || (dependencyCount > 0 && table.m_dependencies == nullptr) ||
+        (count > 0 && (table.m_programIds == nullptr || table.m_flags == nullptr || table.m_roots == nullptr || table.m_state == nullptr ||
+                       table.m_memoryKiB == nullptr || table.m_names == nullptr || table.m_pathOffsets == nullptr || table.m_paths == nullptr || placed == nullptr))) {
+        table = {};
+        return false;
+    }
+
+    /* Dynamic modules are placed from the front and static ones after them, both keep scan order. */
+    u32 nextDynamic = 0, nextStatic = dynamicCount;
+    for (Record *record = this->m_head; record != nullptr; record = record->next) {
+        if (record->hidden)
+            continue;
+
+        u32 index = (record->flags & Flag_NeedReboot) ? nextStatic++ : nextDynamic++;
+        table.m_programIds[index] = record->programId;
+        table.m_flags[index] = record->flags;
+        table.m_roots[index] = record->root;
+        table.m_names[index] = record->name;
+        placed[index] = record;
+    }
+
+    /* Copied in table order, the records' dependencies only have to live until the table is built. */
+    u32 dependencyOffset = 0;
+    for (u32 index = 0; index < count; index++) {
+        const std::span<const u64> dependencies = placed[index]->dependencies;
+        table.m_dependencyOffsets[index] = dependencyOffset;
+        std::copy(dependencies.begin(), dependencies.end(), table.m_dependencies + dependencyOffset);
+        dependencyOffset += dependencies.size();
+    }
+    table.m_dependencyOffsets[count] = dependencyOffset;
+
+    /* "<root>/<program id>/<boot2 flag>", laid out in table order. */
+    char *path = table.m_paths;
+    for (u32 index = 0; index < count; index++) {
+        const ContentRoot &root = ContentRoots[table.m_roots[index]];
+        table.m_pathOffsets[index] = path - table.m_paths;
+        path = append(path, root.path);
+        *path++ = '/';
+        formatProgramId(table.m_programIds[index], path);
+        path += ProgramIdLength;
+        *path++ = '/';
+        path = append(path, root.boot2Flag);
+        *path++ = '\0';
+    }
+    if (count > 0) {
+        std::memset(table.m_state, 0, count);
+        std::memset(table.m_memoryKiB, 0, count * sizeof(u32));
+    }
+
+    table.m_size = count;
+    table.m_dynamicCount = dynamicCount;
+    return true;
+}
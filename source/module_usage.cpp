@@ -0,0 +1,44 @@
+#include "module_usage.hpp"
+
+#include <algorithm>
+
+u32 sampleMemoryUsage(Backend &backend, const u64 *programIds, u32 count, u64 *usedBytes) {
+    u32 running = 0;
+    for (u32 i = 0; i < count; i++) {
+        const Result rc = backend.getMemoryUsage(programIds[i], usedBytes[i]);
+        if (rc == ResultProcessNotFound)
+            usedBytes[i] = 0;
+        else if (R_FAILED(rc))
+            usedBytes[i] = ModuleTable::UnknownMemoryUsage;
+        running += R_SUCCEEDED(rc) && usedBytes[i] > 0;
+    }
+    return running;
+}
+
+UsageSampler::UsageSampler(u64 intervalNs) : m_intervalTicks(armNsToTicks(intervalNs)) {}
+
+bool UsageSampler::sample(ModuleTable &table, Backend &backend) {
+    const u64 now = armGetSystemTick();
+    if (this->m_sampled && now - this->m_lastTick < this->m_intervalTicks)
+        return false;
+    this->m_sampled = true;
+    this->m_lastTick = now;
+
+    if (R_FAILED(backend.getSystemPoolUsage(this->m_poolSize, this->m_poolUsed)))
+        this->m_poolSize = this->m_poolUsed = 0;
+
+    /* In batches, so the results don't need a buffer the size of the table. */
+    constexpr u32 BatchSize = 16;
+    u64 usedBytes[BatchSize];
+    for (u32 begin = 0; begin < table.size(); begin += BatchSize) {
+        const u32 count = std::min(BatchSize, table.size() - begin);
+        sampleMemoryUsage(backend, table.programIds() + begin, count, usedBytes);
+        for (u32 i = 0; i < count; i++) {
+            table.setMemoryUsage(begin + i, usedBytes[i]);
+            /* A query that failed says nothing about whether the module runs. */
+            if (usedBytes[i] != ModuleTable::UnknownMemoryUsage)
+                table.setRunning(begin + i, usedBytes[i] > 0);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,48 @@
+#include "profiled_frame.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+/* Above the footer, which takes the bottom 73 pixels of the frame. */
+static constexpr s32 StripHeight = 64;
+static constexpr s32 StripBottomMargin = 73;
+static constexpr s32 GraphHeight = 36;
+/* The graph's scale doesn't go below a 60 fps frame. */
+static constexpr u64 FrameBudgetNs = 16'666'667;
+
+ProfiledFrame::ProfiledFrame(const std::string &title, const std::string &subtitle, FrameProfiler &profiler) : OverlayFrame(title, subtitle), m_profiler(profiler) {}
+
+void ProfiledFrame::draw(tsl::gfx::Renderer *renderer) {
+    if (!this->m_profiler.enabled()) {
+        OverlayFrame::draw(renderer);
+        return;
+    }
+
+    const u64 start = armGetSystemTick();
+    OverlayFrame::draw(renderer);
+    this->m_profiler.recordDraw(armGetSystemTick() - start);
+    this->drawStrip(renderer);
+}
+
+void ProfiledFrame::drawStrip(tsl::gfx::Renderer *renderer) {
+    const FrameProfiler::Summary summary = this->m_profiler.summarize();
+    const s32 x = 20, w = tsl::cfg::FramebufferWidth - 40;
+    const s32 y = tsl::cfg::FramebufferHeight - StripBottomMargin - StripHeight;
+    renderer->drawRect(x, y, w, StripHeight, renderer->a(tsl::gfx::Color(0x0, 0x0, 0x0, 0xD)));
+
+    char line[96];
+    std::snprintf(line, sizeof(line), "update %lu.%02lu  draw %lu.%02lu  p50 %lu.%02lu  p99 %lu.%02lu ms", summary.lastUpdateNs / 1'000'000,
+                  summary.lastUpdateNs / 10'000 % 100, summary.lastDrawNs / 1'000'000, summary.lastDrawNs / 10'000 % 100, summary.p50Ns / 1'000'000,
+                  summary.p50Ns / 10'000 % 100, summary.p99Ns / 1'000'000, summary.p99Ns / 10'000 % 100);
+    renderer->drawString(line, false, x + 5, y + 18, 14, renderer->a(tsl::style::color::ColorText));
+
+    /* One bar per frame, newest on the right, with lines at the p50 and p99 of the frames shown. */
+    const u64 scaleNs = std::max(summary.maxNs, FrameBudgetNs);
+    const s32 graphY = y + StripHeight - 4, barWidth = std::max<s32>(w / FrameProfiler::Frames, 1);
+    for (u32 age = 0; age < this->m_profiler.count(); age++) {
+        const s32 height = std::max<s32>(GraphHeight * this->m_profiler.frameNs(age) / scaleNs, 1);
+        renderer->drawRect(x + w - (age + 1) * barWidth, graphY - height, std::max(barWidth - 1, 1), height, renderer->a(tsl::style::color::ColorHighlight));
+    }
+    renderer->drawRect(x, graphY - s32(GraphHeight * summary.p50Ns / scaleNs), w, 1, renderer->a(tsl::style::color::ColorText));
+    renderer->drawRect(x, graphY - s32(GraphHeight * summary.p99Ns / scaleNs), w, 1, renderer->a(tsl::style::color::ColorDescription));
+}
@@ -0,0 +1,132 @@
+#include "scan_arena.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <utility>
+
+namespace {
+
+    constexpr size_t alignUp(size_t value, size_t alignment) {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    /* Block headers are padded so the first allocation in a block is maximally aligned. */
+    constexpr size_t HeaderSize = alignUp(3 * sizeof(size_t), alignof(std::max_align_t));
+
+}
+
+ScanArena::ScanArena(ScanArena &&other)
+    : m_head(std::exchange(other.m_head, nullptr)), m_large(std::exchange(other.m_large, nullptr)), m_blockSize(other.m_blockSize),
+      m_reserved(std::exchange(other.m_reserved, 0)), m_blocks(std::exchange(other.m_blocks, 0)) {
+}
+
+ScanArena &ScanArena::operator=(ScanArena &&other) {
+    if (this != &other) {
+        this->release();
+        this->m_head = std::exchange(other.m_head, nullptr);
+        this->m_large = std::exchange(other.m_large, nullptr);
+        this->m_blockSize = other.m_blockSize;
+        this->m_reserved = std::exchange(other.m_reserved, 0);
+        this->m_blocks = std::exchange(other.m_blocks, 0);
+    }
+    return *this;
+}
+
+ScanArena::~ScanArena() {
+    this->release();
+}
+
+void *ScanArena::allocate(size_t size, size_t alignment) {
+    if (this->m_head != nullptr) {
+        size_t offset = alignUp(HeaderSize + this->m_head->used, alignment);
+        if (offset + size <= HeaderSize + this->m_head->size) {
+            this->m_head->used = offset + size - HeaderSize;
+            return reinterpret_cast<u8 *>(this->m_head) + offset;
+        }
+    }
+
+    /*
+     * Allocations that don't fit a regular block get one of their own. It
+     * doesn't become the current block, what's left of that is still used by
+     * the allocations after it.
+     */
+    const bool large = size + alignment > this->m_blockSize / 2;
+    size_t capacity = large ? size + alignment : this->m_blockSize;
+    auto *block = static_cast<Block *>(::operator new(HeaderSize + capacity, std::nothrow));
+    if (block == nullptr)
+        return nullptr;
+
+    Block *&list = large ? this->m_large : this->m_head;
+    block->next = list;
+    block->size = capacity;
+    block->used = 0;
+    list = block;
+    this->m_reserved += capacity;
+    this->m_blocks++;
+
+    size_t offset = alignUp(HeaderSize, alignment);
+    block->used = offset + size - HeaderSize;
+    return reinterpret_cast<u8 *>(block) + offset;
+}
+
+void ScanArena::shrink(void *ptr, size_t size) {
+    /* A large allocation keeps its block, only the current block can take bytes back. */
+    if (this->m_head == nullptr)
+        return;
+    auto *start = reinterpret_cast<u8 *>(this->m_head) + HeaderSize;
+    auto *data = static_cast<u8 *>(ptr);
+    if (data >= start && data + size <= start + this->m_head->used)
+        this->m_head->used = data - start + size;
+}
+
+std::string_view ScanArena::copy(std::string_view str) {
+    char *data = static_cast<char *>(this->allocate(str.size(), 1));
+    if (data == nullptr)
+        return {};
+    std::memcpy(data, str.data(), str.size());
+    return { data, str.size() };
+}
+
+ScanArena::Marker ScanArena::mark() const {
+    return { this->m_head, this->m_head != nullptr ? this->m_head->used : 0, this->m_large };
+}
+
+void ScanArena::rewind(const Marker &marker) {
+    auto freeUntil = [this](Block *&list, void *until) {
+        while (list != nullptr && list != until) {
+            Block *next = list->next;
+            this->m_reserved -= list->size;
+            this->m_blocks--;
+            ::operator delete(list);
+            list = next;
+        }
+    };
+    freeUntil(this->m_head, marker.block);
+    freeUntil(this->m_large, marker.large);
+    if (this->m_head != nullptr)
+        this->m_head->used = marker.used;
+}
+
+void ScanArena::release() {
+    this->rewind({ nullptr, 0, nullptr });
+}
+
+void ScanArena::adopt(ScanArena &other) {
+    /* Other's blocks go behind ours so that allocations continue in our current block. */
+    auto append = [](Block *&list, Block *blocks, bool behindFirst) {
+        if (blocks == nullptr)
+            return;
+        Block *tail = blocks;
+        while (tail->next != nullptr)
+            tail = tail->next;
+        Block *&after = list != nullptr && behindFirst ? list->next : list;
+        tail->next = after;
+        after = blocks;
+    };
+    append(this->m_head, std::exchange(other.m_head, nullptr), true);
+    append(this->m_large, std::exchange(other.m_large, nullptr), false);
+
+    this->m_reserved += std::exchange(other.m_reserved, 0);
+    this->m_blocks += std::exchange(other.m_blocks, 0);
+}
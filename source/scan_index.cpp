@@ -0,0 +1,171 @@
+#include "scan_index.hpp"
+
+#include "ipc_stats.hpp"
+#include "toolbox.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+    bool entryLess(const ScanIndex::Entry &lhs, u8 root, u64 programId) {
+        return lhs.root != root ? lhs.root < root : lhs.programId < programId;
+    }
+
+    constexpr Result ResultInvalidIndex = MAKERESULT(Module_Libnx, LibnxError_BadInput);
+
+    /* Creates every missing parent directory of path. */
+    void createParentDirectories(FsFileSystem *fs, const char *path) {
+        char directory[FS_MAX_PATH];
+        for (const char *slash = std::strchr(path + 1, '/'); slash != nullptr; slash = std::strchr(slash + 1, '/')) {
+            size_t length = std::min<size_t>(slash - path, FS_MAX_PATH - 1);
+            std::memcpy(directory, path, length);
+            directory[length] = '\0';
+            ipcCall(IpcCall::FsCreateDirectory, fsFsCreateDirectory, fs, directory);
+        }
+    }
+
+}
+
+Result getModificationTime(FsFileSystem *fs, const char *path, u64 &modified) {
+    FsTimeStampRaw timeStamp = {};
+    Result rc = ipcCall(IpcCall::FsGetFileTimeStamp, fsFsGetFileTimeStampRaw, fs, path, &timeStamp);
+    if (R_SUCCEEDED(rc))
+        modified = timeStamp.is_valid ? timeStamp.modified : 0;
+    return rc;
+}
+
+Result ScanIndex::load(FsFileSystem *fs, const char *path, ScanArena &arena) {
+    *this = {};
+
+    FsFile file;
+    Result rc = ipcCall(IpcCall::FsOpenFile, fsFsOpenFile, fs, path, FsOpenMode_Read, &file);
+    if (R_FAILED(rc))
+        return rc;
+
+    s64 size = 0;
+    u8 *data = nullptr;
+    u64 bytesRead = 0;
+    if (R_SUCCEEDED(rc = ipcCall(IpcCall::FsFileGetSize, fsFileGetSize, &file, &size))) {
+        data = static_cast<u8 *>(arena.allocate(size, alignof(Entry)));
+        if (data == nullptr)
+            rc = MAKERESULT(Module_Libnx, LibnxError_OutOfMemory);
+        else
+            rc = ipcCall(IpcCall::FsFileRead, fsFileRead, &file, 0, data, size, FsReadOption_None, &bytesRead);
+    }
+    ipcCall(IpcCall::FsFileClose, fsFileClose, &file);
+    if (R_FAILED(rc))
+        return rc;
+
+    Header header;
+    if (bytesRead < sizeof(header))
+        return ResultInvalidIndex;
+    std::memcpy(&header, data, sizeof(header));
+    if (header.magic != Magic || header.version != Version)
+        return ResultInvalidIndex;
+    if (sizeof(Header) + u64(header.entryCount) * sizeof(Entry) + header.namesSize != bytesRead)
+        return ResultInvalidIndex;
+
+    const auto *entries = reinterpret_cast<const Entry *>(data + sizeof(Header));
+    for (u32 i = 0; i < header.entryCount; i++) {
+        const Entry &entry = entries[i];
+        if (u64(entry.nameOffset) + entry.nameLength + entry.dependencyCount * sizeof(u64) > header.namesSize || entry.dependencyCount > MaxDependencies)
+            return ResultInvalidIndex;
+        if (entry.source == ModuleSource::None || entry.source > ModuleSource::ExefsNpdm)
+            return ResultInvalidIndex;
+        if (entry.root >= ContentRootCount || (i > 0 && !entryLess(entries[i - 1], entry.root, entry.programId)))
+            return ResultInvalidIndex;
+    }
+
+    this->m_entries = entries;
+    this->m_names = reinterpret_cast<const char *>(entries + header.entryCount);
+    this->m_count = header.entryCount;
+    return 0;
+}
+
+const ScanIndex::Entry *ScanIndex::find(u8 root, u64 programId) const {
+    const Entry *end = this->m_entries + this->m_count;
+    const Entry *entry = std::lower_bound(this->m_entries, end, programId, [root](const Entry &entry, u64 programId) {
+        return entryLess(entry, root, programId);
+    });
+    return entry != end && entry->root == root && entry->programId == programId ? entry : nullptr;
+}
+
+void ScanIndex::dependencies(const Entry &entry, u64 *out) const {
+    std::memcpy(out, this->m_names + entry.nameOffset + entry.nameLength, entry.dependencyCount * sizeof(u64));
+}
+
+bool ScanIndex::Writer::add(u64 programId, u8 root, u64 modified, ModuleSource source, u8 flags, std::string_view name, std::span<const u64> dependencies) {
+    if (name.size() > MaxNameLength || dependencies.size() > MaxDependencies)
+        return true;
+
+    auto *record = this->m_records.allocateArray<Record>(1);
+    if (record == nullptr)
+        return false;
+
+    *record = { this->m_head, programId, modified, name, dependencies, root, source, flags };
+    this->m_head = record;
+    this->m_count++;
+    this->m_namesSize += name.size() + dependencies.size_bytes();
+    return true;
+}
+
+u8 *ScanIndex::Writer::layout(ScanArena &arena, size_t &size) const {
+    size = sizeof(Header) + this->m_count * sizeof(Entry) + this->m_namesSize;
+    u8 *data = static_cast<u8 *>(arena.allocate(size, alignof(Entry)));
+    if (data == nullptr)
+        return nullptr;
+
+    const Header header = { Magic, Version, this->m_count, this->m_namesSize };
+    std::memcpy(data, &header, sizeof(header));
+
+    auto *entries = reinterpret_cast<Entry *>(data + sizeof(Header));
+    char *names = reinterpret_cast<char *>(entries + this->m_count);
+    u32 index = 0, nameOffset = 0;
+    for (Record *record = this->m_head; record != nullptr; record = record->next, index++) {
+        entries[index] = { record->programId, record->modified, nameOffset, u8(record->name.size()), record->root, record->source, record->flags,
+                           u8(record->dependencies.size()), {} };
+        std::memcpy(names + nameOffset, record->name.data(), record->name.size());
+        nameOffset += record->name.size();
+        std::memcpy(names + nameOffset, record->dependencies.data(), record->dependencies.size_bytes());
+        nameOffset += record->dependencies.size_bytes();
+    }
+    std::sort(entries, entries + this->m_count, [](const Entry &lhs, const Entry &rhs) {
+        return entryLess(lhs, rhs.root, rhs.programId);
+    });
+    return data;
+}
+
+Result ScanIndex::Writer::save(FsFileSystem *fs, const char *path) {
+    size_t size;
+    u8 *data = this->layout(this->m_records, size);
+    if (data == nullptr)
+        return MAKERESULT(Module_Libnx, LibnxError_OutOfMemory);
+
+    /* Recreated with the exact size, there's no truncating an existing file. */
+    createParentDirectories(fs, path);
+    ipcCall(IpcCall::FsDeleteFile, fsFsDeleteFile, fs, path);
+    Result rc = ipcCall(IpcCall::FsCreateFile, fsFsCreateFile, fs, path, size, 0);
+    if (R_FAILED(rc))
+        return rc;
+
+    FsFile file;
+    if (R_FAILED(rc = ipcCall(IpcCall::FsOpenFile, fsFsOpenFile, fs, path, FsOpenMode_Write, &file)))
+        return rc;
+    rc = ipcCall(IpcCall::FsFileWrite, fsFileWrite, &file, 0, data, size, FsWriteOption_Flush);
+    ipcCall(IpcCall::FsFileClose, fsFileClose, &file);
+    return rc;
+}
+
+bool ScanIndex::Writer::build(ScanArena &arena, ScanIndex &index) const {
+    size_t size;
+    const u8 *data = this->layout(arena, size);
+    if (data == nullptr)
+        return false;
+
+    const auto *entries = reinterpret_cast<const Entry *>(data + sizeof(Header));
+    index.m_entries = entries;
+    index.m_names = reinterpret_cast<const char *>(entries + this->m_count);
+    index.m_count = this->m_count;
+    return true;
+}
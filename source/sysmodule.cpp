@@ -0,0 +1,134 @@
+#include "sysmodule.hpp"
+
+#include "ipc_stats.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+bool fileExists(FsFileSystem *fs, const char *path) {
+    FsFile file;
+    Result rc = ipcCall(IpcCall::FsOpenFile, fsFsOpenFile, fs, path, FsOpenMode_Read, &file);
+    if (R_SUCCEEDED(rc)) {
+        ipcCall(IpcCall::FsFileClose, fsFileClose, &file);
+        return true;
+    } else {
+        return false;
+    }
+}
+
+Result readFile(FsFileSystem *fs, const char *path, ScanArena &arena, std::string_view &data) {
+    FsFile file;
+    Result rc = ipcCall(IpcCall::FsOpenFile, fsFsOpenFile, fs, path, FsOpenMode_Read, &file);
+    if (R_FAILED(rc))
+        return rc;
+
+    s64 size;
+    rc = ipcCall(IpcCall::FsFileGetSize, fsFileGetSize, &file, &size);
+    if (R_SUCCEEDED(rc)) {
+        char *buffer = static_cast<char *>(arena.allocate(size, 1));
+        u64 bytesRead = 0;
+        if (buffer == nullptr && size > 0)
+            rc = MAKERESULT(Module_Libnx, LibnxError_OutOfMemory);
+        else
+            rc = ipcCall(IpcCall::FsFileRead, fsFileRead, &file, 0, buffer, size, FsReadOption_None, &bytesRead);
+        data = std::string_view(buffer, bytesRead);
+    }
+
+    ipcCall(IpcCall::FsFileClose, fsFileClose, &file);
+    return rc;
+}
+
+bool isProgramRunning(u64 programId) {
+    u64 pid = 0;
+    if (R_FAILED(ipcCall(IpcCall::PmdmntGetProcessId, pmdmntGetProcessId, &pid, programId)))
+        return false;
+
+    return pid > 0;
+}
+
+Result getProgramMemoryUsage(u64 programId, u64 &usedBytes) {
+    u64 pid = 0;
+    Result rc = ipcCall(IpcCall::PmdmntGetProcessId, pmdmntGetProcessId, &pid, programId);
+    if (R_FAILED(rc))
+        return rc;
+
+    Handle process;
+    NcmProgramLocation location;
+    CfgOverrideStatus status;
+    if (R_FAILED(rc = ipcCall(IpcCall::PmdmntGetProcessInfo, pmdmntAtmosphereGetProcessInfo, &process, &location, &status, pid)))
+        return rc;
+
+    rc = ipcCall(IpcCall::SvcGetInfo, svcGetInfo, &usedBytes, InfoType_UsedMemorySize, process, 0);
+    svcCloseHandle(process);
+    return rc;
+}
+
+Result getSystemPoolUsage(u64 &size, u64 &usedBytes) {
+    Result rc = ipcCall(IpcCall::SvcGetSystemInfo, svcGetSystemInfo, &size, SystemInfoType_TotalPhysicalMemorySize, INVALID_HANDLE, PhysicalMemorySystemInfo_System);
+    if (R_SUCCEEDED(rc))
+        rc = ipcCall(IpcCall::SvcGetSystemInfo, svcGetSystemInfo, &usedBytes, SystemInfoType_UsedPhysicalMemorySize, INVALID_HANDLE, PhysicalMemorySystemInfo_System);
+    return rc;
+}
+
+Result CopyFile(FsFileSystem *fs, const char *srcPath, const char *destPath) {
+    Result ret{0};
+    FsFile src_handle, dest_handle;
+    if (R_FAILED(ret = ipcCall(IpcCall::FsOpenFile, fsFsOpenFile, fs, srcPath, FsOpenMode_Read, &src_handle))) return ret;
+
+    s64 size = 0;
+    if (R_FAILED(ret = ipcCall(IpcCall::FsFileGetSize, fsFileGetSize, &src_handle, &size))) {
+        ipcCall(IpcCall::FsFileClose, fsFileClose, &src_handle);
+        return ret;
+    }
+
+    if (R_SUCCEEDED(ipcCall(IpcCall::FsOpenFile, fsFsOpenFile, fs, destPath, FsOpenMode_Read, &dest_handle))) {
+        ipcCall(IpcCall::FsFileClose, fsFileClose, &dest_handle);
+        if (R_FAILED(ret = ipcCall(IpcCall::FsDeleteFile, fsFsDeleteFile, fs, destPath)) || R_FAILED(ret = ipcCall(IpcCall::FsCreateFile, fsFsCreateFile, fs, destPath, size, 0))) {
+            ipcCall(IpcCall::FsFileClose, fsFileClose, &src_handle);
+            return ret;
+        }
+    }
+
+    if (R_FAILED(ret = ipcCall(IpcCall::FsOpenFile, fsFsOpenFile, fs, destPath, FsOpenMode_Write, &dest_handle))) {
+        ipcCall(IpcCall::FsFileClose, fsFileClose, &src_handle);
+        return ret;
+    }
+
+    u64 bytes_read = 0;
+    const u64 buf_size = 0x10000;
+    s64 offset = 0;
+    unsigned char *buf = new unsigned char[buf_size];
+
+    do {
+        std::memset(buf, 0, buf_size);
+        if (R_FAILED(ret = ipcCall(IpcCall::FsFileRead, fsFileRead, &src_handle, offset, buf, buf_size, FsReadOption_None, &bytes_read))) break;
+        if (R_FAILED(ret = ipcCall(IpcCall::FsFileWrite, fsFileWrite, &dest_handle, offset, buf, bytes_read, FsWriteOption_Flush))) break;
+        offset += bytes_read;
+    } while (offset < size);
+
+    delete[] buf;
+    ipcCall(IpcCall::FsFileClose, fsFileClose, &dest_handle);
+    ipcCall(IpcCall::FsFileClose, fsFileClose, &src_handle);
+    return ret;
+}
+
+Result AppendFile(FsFileSystem *fs, const char *path, const void *data, size_t size, s64 maxSize) {
+    FsFile file;
+    s64 offset = 0;
+    if (R_SUCCEEDED(ipcCall(IpcCall::FsOpenFile, fsFsOpenFile, fs, path, FsOpenMode_Write | FsOpenMode_Append, &file))) {
+        if (R_SUCCEEDED(ipcCall(IpcCall::FsFileGetSize, fsFileGetSize, &file, &offset)) && offset + s64(size) <= maxSize) {
+            Result rc = ipcCall(IpcCall::FsFileWrite, fsFileWrite, &file, offset, data, size, FsWriteOption_Flush);
+            ipcCall(IpcCall::FsFileClose, fsFileClose, &file);
+            return rc;
+        }
+        ipcCall(IpcCall::FsFileClose, fsFileClose, &file);
+        ipcCall(IpcCall::FsDeleteFile, fsFsDeleteFile, fs, path);
+    }
+
+    Result rc = ipcCall(IpcCall::FsCreateFile, fsFsCreateFile, fs, path, 0, 0);
+    if (R_FAILED(rc) || R_FAILED(rc = ipcCall(IpcCall::FsOpenFile, fsFsOpenFile, fs, path, FsOpenMode_Write | FsOpenMode_Append, &file)))
+        return rc;
+    rc = ipcCall(IpcCall::FsFileWrite, fsFileWrite, &file, 0, data, size, FsWriteOption_Flush);
+    ipcCall(IpcCall::FsFileClose, fsFileClose, &file);
+    return rc;
+}
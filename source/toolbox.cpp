@@ -0,0 +1,298 @@
+#include "toolbox.hpp"
+
+#include "program_id.hpp"
+
+#include <cstring>
+
+namespace {
+
+    /* Deeper nesting than this is rejected instead of recursing any further. */
+    constexpr u32 MaxDepth = 32;
+
+    class JsonReader {
+      private:
+        const char *m_pos;
+        const char *m_end;
+
+      public:
+        explicit JsonReader(std::string_view data) : m_pos(data.data()), m_end(data.data() + data.size()) {}
+
+        bool atEnd() {
+            this->skipWhitespace();
+            return this->m_pos == this->m_end;
+        }
+
+        bool consume(char c) {
+            this->skipWhitespace();
+            if (this->m_pos == this->m_end || *this->m_pos != c)
+                return false;
+            this->m_pos++;
+            return true;
+        }
+
+        bool peek(char c) {
+            this->skipWhitespace();
+            return this->m_pos != this->m_end && *this->m_pos == c;
+        }
+
+        /* Reads a string and returns its body without the quotes, escapes are validated but kept. */
+        bool string(std::string_view &raw) {
+            if (!this->consume('"'))
+                return false;
+
+            const char *start = this->m_pos;
+            while (this->m_pos != this->m_end) {
+                char c = *this->m_pos++;
+                if (c == '"') {
+                    raw = std::string_view(start, this->m_pos - start - 1);
+                    return true;
+                }
+                if (static_cast<unsigned char>(c) < 0x20)
+                    return false;
+                if (c != '\\')
+                    continue;
+
+                if (this->m_pos == this->m_end)
+                    return false;
+                c = *this->m_pos++;
+                if (c == 'u') {
+                    for (u32 i = 0; i < 4; i++, this->m_pos++) {
+                        if (this->m_pos == this->m_end || !isHexDigit(*this->m_pos))
+                            return false;
+                    }
+                } else if (std::strchr("\"\\/bfnrt", c) == nullptr || c == '\0') {
+                    return false;
+                }
+            }
+            return false;
+        }
+
+        /* An array of program ids, at most max of them. */
+        bool programIds(u64 *ids, u8 &count, u32 max) {
+            count = 0;
+            if (!this->consume('['))
+                return false;
+            if (this->consume(']'))
+                return true;
+            do {
+                std::string_view id;
+                if (count == max || !this->string(id) || !parseProgramId(id, ids[count]))
+                    return false;
+                count++;
+            } while (this->consume(','));
+            return this->consume(']');
+        }
+
+        bool boolean(bool &value) {
+            if (this->literal("true"))
+                value = true;
+            else if (this->literal("false"))
+                value = false;
+            else
+                return false;
+            return true;
+        }
+
+        /* Skips over any value, validating it on the way. */
+        bool skipValue(u32 depth = 0) {
+            if (depth > MaxDepth)
+                return false;
+
+            this->skipWhitespace();
+            if (this->m_pos == this->m_end)
+                return false;
+
+            std::string_view ignored;
+            switch (*this->m_pos) {
+                case '"':
+                    return this->string(ignored);
+                case '{':
+                    this->m_pos++;
+                    if (this->consume('}'))
+                        return true;
+                    do {
+                        if (!this->string(ignored) || !this->consume(':') || !this->skipValue(depth + 1))
+                            return false;
+                    } while (this->consume(','));
+                    return this->consume('}');
+                case '[':
+                    this->m_pos++;
+                    if (this->consume(']'))
+                        return true;
+                    do {
+                        if (!this->skipValue(depth + 1))
+                            return false;
+                    } while (this->consume(','));
+                    return this->consume(']');
+                case 't':
+                    return this->literal("true");
+                case 'f':
+                    return this->literal("false");
+                case 'n':
+                    return this->literal("null");
+                default:
+                    return this->number();
+            }
+        }
+
+      private:
+        static bool isHexDigit(char c) {
+            return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+        }
+
+        static bool isDigit(char c) {
+            return c >= '0' && c <= '9';
+        }
+
+        void skipWhitespace() {
+            while (this->m_pos != this->m_end && (*this->m_pos == ' ' || *this->m_pos == '\t' || *this->m_pos == '\n' || *this->m_pos == '\r'))
+                this->m_pos++;
+        }
+
+        bool literal(std::string_view text) {
+            this->skipWhitespace();
+            if (size_t(this->m_end - this->m_pos) < text.size() || std::string_view(this->m_pos, text.size()) != text)
+                return false;
+            this->m_pos += text.size();
+            return true;
+        }
+
+        bool digits() {
+            const char *start = this->m_pos;
+            while (this->m_pos != this->m_end && isDigit(*this->m_pos))
+                this->m_pos++;
+            return this->m_pos != start;
+        }
+
+        bool number() {
+            if (this->m_pos != this->m_end && *this->m_pos == '-')
+                this->m_pos++;
+            if (this->m_pos != this->m_end && *this->m_pos == '0')
+                this->m_pos++;
+            else if (!this->digits())
+                return false;
+
+            if (this->m_pos != this->m_end && *this->m_pos == '.') {
+                this->m_pos++;
+                if (!this->digits())
+                    return false;
+            }
+            if (this->m_pos != this->m_end && (*this->m_pos == 'e' || *this->m_pos == 'E')) {
+                this->m_pos++;
+                if (this->m_pos != this->m_end && (*this->m_pos == '+' || *this->m_pos == '-'))
+                    this->m_pos++;
+                if (!this->digits())
+                    return false;
+            }
+            return true;
+        }
+    };
+
+    u32 hexValue(const char *digits) {
+        u32 value = 0;
+        for (u32 i = 0; i < 4; i++) {
+            char c = digits[i];
+            value = value * 16 + (c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10);
+        }
+        return value;
+    }
+
+    size_t encodeUtf8(u32 codepoint, char *out) {
+        if (codepoint < 0x80) {
+            out[0] = codepoint;
+            return 1;
+        } else if (codepoint < 0x800) {
+            out[0] = 0xC0 | (codepoint >> 6);
+            out[1] = 0x80 | (codepoint & 0x3F);
+            return 2;
+        } else if (codepoint < 0x10000) {
+            out[0] = 0xE0 | (codepoint >> 12);
+            out[1] = 0x80 | ((codepoint >> 6) & 0x3F);
+            out[2] = 0x80 | (codepoint & 0x3F);
+            return 3;
+        } else {
+            out[0] = 0xF0 | (codepoint >> 18);
+            out[1] = 0x80 | ((codepoint >> 12) & 0x3F);
+            out[2] = 0x80 | ((codepoint >> 6) & 0x3F);
+            out[3] = 0x80 | (codepoint & 0x3F);
+            return 4;
+        }
+    }
+
+}
+
+bool parseToolbox(std::string_view data, ToolboxInfo &info) {
+    JsonReader reader(data);
+    if (!reader.consume('{'))
+        return false;
+
+    std::string_view tid;
+    bool hasTid = false, hasName = false, hasNeedReboot = false;
+    info.dependencyCount = 0;
+    if (!reader.peek('}')) {
+        do {
+            std::string_view key;
+            if (!reader.string(key) || !reader.consume(':'))
+                return false;
+
+            /* Like the json DOM this replaced, the last occurrence of a duplicate key wins. */
+            bool valid;
+            if (key == "tid")
+                valid = hasTid = reader.string(tid);
+            else if (key == "name")
+                valid = hasName = reader.string(info.rawName);
+            else if (key == "requires_reboot")
+                valid = hasNeedReboot = reader.boolean(info.needReboot);
+            else if (key == "dependencies")
+                valid = reader.programIds(info.dependencies, info.dependencyCount, MaxDependencies);
+            else
+                valid = reader.skipValue();
+
+            if (!valid)
+                return false;
+        } while (reader.consume(','));
+    }
+
+    if (!reader.consume('}') || !reader.atEnd())
+        return false;
+    if (!hasTid || !hasName || !hasNeedReboot)
+        return false;
+
+    /* Escapes aren't valid hex digits, so the raw body can be parsed directly. */
+    return parseProgramId(tid, info.programId);
+}
+
+size_t unescapeJsonString(std::string_view raw, char *out) {
+    /* Output never gets ahead of input, so out may point to the start of raw itself. */
+    size_t length = 0;
+    for (size_t i = 0; i < raw.size(); i++) {
+        if (raw[i] != '\\') {
+            out[length++] = raw[i];
+            continue;
+        }
+
+        char c = raw[++i];
+        switch (c) {
+            case 'b': out[length++] = '\b'; break;
+            case 'f': out[length++] = '\f'; break;
+            case 'n': out[length++] = '\n'; break;
+            case 'r': out[length++] = '\r'; break;
+            case 't': out[length++] = '\t'; break;
+            case 'u': {
+                u32 codepoint = hexValue(raw.data() + i + 1);
+                i += 4;
+                if (codepoint >= 0xD800 && codepoint < 0xDC00 && i + 6 < raw.size() && raw[i + 1] == '\\' && raw[i + 2] == 'u') {
+                    u32 low = hexValue(raw.data() + i + 3);
+                    if (low >= 0xDC00 && low < 0xE000) {
+                        codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+                        i += 6;
+                    }
+                }
+                length += encodeUtf8(codepoint, out + length);
+                break;
+            }
+            default: out[length++] = c; break;
+        }
+    }
+    return length;
+}
@@ -0,0 +1,142 @@
+#include "virtual_list.hpp"
+
+VirtualList::VirtualList(u32 count, u32 visibleRows, u32 marginRows, BindCallback bind, ClickCallback click)
+    : m_window(visibleRows, marginRows), m_bind(std::move(bind)), m_click(std::move(click)) {
+    this->setCount(count);
+}
+
+VirtualList::~VirtualList() {
+    for (auto *row : this->m_rows)
+        delete row;
+}
+
+void VirtualList::setCount(u32 count) {
+    this->m_window.setCount(count);
+
+    /* Rows are only ever added, a shrinking list just leaves some of them unbound. */
+    u32 rows = std::min(count, this->m_window.poolSize());
+    while (this->m_rows.size() < rows) {
+        u32 slot = this->m_rows.size();
+        auto *row = new tsl::elm::ListItem("");
+        row->setParent(this);
+        row->setClickListener([this, slot](u64 keys) -> bool {
+            u32 index = this->m_slotIndex[slot];
+            return index != UnboundSlot && this->m_click(index, keys);
+        });
+        this->m_rows.push_back(row);
+        this->m_slotIndex.push_back(UnboundSlot);
+    }
+
+    std::fill(this->m_slotIndex.begin(), this->m_slotIndex.end(), UnboundSlot);
+    this->bindWindow();
+
+    /* The surrounding list has to make room when the number of shown rows changes. */
+    if (this->getHeight() != this->getListHeight() && this->getParent() != nullptr) {
+        this->setBoundaries(this->getX(), this->getY(), this->getWidth(), this->getListHeight());
+        this->getParent()->invalidate();
+    }
+    this->layoutRows();
+}
+
+void VirtualList::setCount(u32 count, u32 cursor) {
+    this->m_window.setCount(count);
+    this->m_window.moveTo(cursor);
+    this->setCount(count);
+}
+
+void VirtualList::refresh() {
+    for (u32 index = this->m_window.boundBegin(); index < this->m_window.boundEnd(); index++)
+        this->m_bind(this->rowAt(index), index, false);
+}
+
+void VirtualList::draw(tsl::gfx::Renderer *renderer) {
+    u32 first = this->m_window.first();
+    for (u32 index = first; index < first + this->m_window.visibleCount(); index++)
+        this->rowAt(index)->frame(renderer);
+
+    /* Scrollbar for the part of the list that isn't shown. */
+    u32 count = this->m_window.count();
+    u32 visible = this->m_window.visibleRows();
+    if (count > visible) {
+        s32 height = this->getHeight() * visible / count;
+        s32 offset = (this->getHeight() - height) * first / (count - visible);
+        renderer->drawRect(this->getX() + this->getWidth() + 4, this->getY() + offset, 3, height, renderer->a(tsl::style::color::ColorHandle));
+    }
+}
+
+void VirtualList::layout(u16 parentX, u16 parentY, u16 parentWidth, u16 parentHeight) {
+    this->layoutRows();
+}
+
+tsl::elm::Element *VirtualList::requestFocus(tsl::elm::Element *oldFocus, tsl::FocusDirection direction) {
+    u32 count = this->m_window.count();
+    if (count == 0)
+        return nullptr;
+
+    /* Focus coming from outside enters at the end closest to where it came from. */
+    if (!this->ownsRow(oldFocus)) {
+        if (direction == tsl::FocusDirection::Down)
+            this->scrollTo(0);
+        else if (direction == tsl::FocusDirection::Up)
+            this->scrollTo(count - 1);
+        return this->rowAt(this->m_window.cursor());
+    }
+
+    u32 cursor = this->m_window.cursor();
+    if (direction == tsl::FocusDirection::None)
+        return this->rowAt(cursor);
+    if (direction == tsl::FocusDirection::Down && cursor + 1 < count) {
+        this->scrollTo(cursor + 1);
+        return this->rowAt(cursor + 1);
+    }
+    if (direction == tsl::FocusDirection::Up && cursor > 0) {
+        this->scrollTo(cursor - 1);
+        return this->rowAt(cursor - 1);
+    }
+
+    /* Past either end, the surrounding list decides where focus goes next. */
+    if (this->getParent() != nullptr)
+        return this->getParent()->requestFocus(oldFocus, direction);
+    return oldFocus;
+}
+
+bool VirtualList::onTouch(tsl::elm::TouchEvent event, s32 currX, s32 currY, s32 prevX, s32 prevY, s32 initialX, s32 initialY) {
+    u32 first = this->m_window.first();
+    for (u32 index = first; index < first + this->m_window.visibleCount(); index++) {
+        if (this->rowAt(index)->onTouch(event, currX, currY, prevX, prevY, initialX, initialY))
+            return true;
+    }
+    return false;
+}
+
+tsl::elm::ListItem *VirtualList::rowAt(u32 index) const {
+    return this->m_rows[this->m_window.slotOf(index)];
+}
+
+bool VirtualList::ownsRow(tsl::elm::Element *element) const {
+    return element != nullptr && element->getParent() == this;
+}
+
+void VirtualList::scrollTo(u32 index) {
+    if (this->m_window.moveTo(index)) {
+        this->bindWindow();
+        this->layoutRows();
+    }
+}
+
+void VirtualList::bindWindow() {
+    for (u32 index = this->m_window.boundBegin(); index < this->m_window.boundEnd(); index++) {
+        u32 slot = this->m_window.slotOf(index);
+        if (this->m_slotIndex[slot] == index)
+            continue;
+
+        this->m_slotIndex[slot] = index;
+        this->m_bind(this->m_rows[slot], index, true);
+    }
+}
+
+void VirtualList::layoutRows() {
+    u32 first = this->m_window.first();
+    for (u32 index = first; index < first + this->m_window.visibleCount(); index++)
+        this->rowAt(index)->setBoundaries(this->getX(), this->getY() + (index - first) * RowHeight, this->getWidth(), RowHeight);
+}
@@ -0,0 +1,110 @@
+#include "work_pool.hpp"
+
+#include <algorithm>
+
+namespace {
+
+    constexpr u64 pack(u32 begin, u32 end) {
+        return u64(begin) | u64(end) << 32;
+    }
+
+    constexpr u32 beginOf(u64 bounds) {
+        return u32(bounds);
+    }
+
+    constexpr u32 endOf(u64 bounds) {
+        return u32(bounds >> 32);
+    }
+
+}
+
+WorkPool::WorkPool(u32 workers) : m_workers(std::clamp<u32>(workers, 1, MaxWorkers)) {
+    for (auto &share : this->m_shares)
+        share.bounds.store(0, std::memory_order_relaxed);
+}
+
+bool WorkPool::next(u32 worker, u32 &index) {
+    std::atomic<u64> &bounds = this->m_shares[worker].bounds;
+    u64 current = bounds.load(std::memory_order_acquire);
+    while (beginOf(current) < endOf(current)) {
+        if (bounds.compare_exchange_weak(current, pack(beginOf(current) + 1, endOf(current)), std::memory_order_acq_rel)) {
+            index = beginOf(current);
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * Only called once the worker's own share is empty, nobody else writes an
+ * empty share. Indices are handed out once, so a share never goes back to
+ * bounds another worker might still be comparing against.
+ */
+bool WorkPool::steal(u32 worker) {
+    for (u32 i = 1; i < this->m_active; i++) {
+        std::atomic<u64> &victim = this->m_shares[(worker + i) % this->m_active].bounds;
+        u64 current = victim.load(std::memory_order_acquire);
+        while (beginOf(current) < endOf(current)) {
+            const u32 begin = beginOf(current), end = endOf(current);
+            const u32 middle = end - (end - begin + 1) / 2;
+            if (victim.compare_exchange_weak(current, pack(begin, middle), std::memory_order_acq_rel)) {
+                this->m_shares[worker].bounds.store(pack(middle, end), std::memory_order_release);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void WorkPool::work(u32 worker) {
+    while (true) {
+        u32 index;
+        if (!this->next(worker, index)) {
+            if (!this->steal(worker))
+                return;
+            continue;
+        }
+        this->m_task(this->m_context, worker, index);
+    }
+}
+
+void WorkPool::threadEntry(void *arg) {
+    Worker *worker = static_cast<Worker *>(arg);
+    worker->pool->work(worker->index);
+}
+
+u32 WorkPool::run(u32 count, Task task, void *context) {
+    if (count == 0)
+        return 0;
+
+    this->m_task = task;
+    this->m_context = context;
+    this->m_active = std::min(this->m_workers, count);
+    for (u32 i = 0; i < this->m_active; i++) {
+        const u32 begin = u64(count) * i / this->m_active, end = u64(count) * (i + 1) / this->m_active;
+        this->m_shares[i].bounds.store(pack(begin, end), std::memory_order_relaxed);
+    }
+
+    Worker workers[MaxWorkers];
+    u32 started = 0;
+    for (u32 i = 1; i < this->m_active; i++) {
+        Worker &worker = workers[started];
+        worker.pool = this;
+        worker.index = i;
+        if (R_FAILED(threadCreate(&worker.thread, threadEntry, &worker, nullptr, StackSize, ThreadPriority, -2)))
+            continue;
+        if (R_FAILED(threadStart(&worker.thread))) {
+            threadClose(&worker.thread);
+            continue;
+        }
+        started++;
+    }
+
+    this->work(0);
+
+    for (u32 i = 0; i < started; i++) {
+        threadWaitForExit(&workers[i].thread);
+        threadClose(&workers[i].thread);
+    }
+    return started + 1;
+}